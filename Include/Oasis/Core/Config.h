@@ -16,9 +16,60 @@ enum class GraphicsBackend
 
 struct OASIS_API Config
 {
+    // NONE runs without a window, rendering to a device that draws nothing
     GraphicsBackend graphicsBackend = GraphicsBackend::DONT_CARE;
+
+    // frames are rendered at most this often, 0 renders as often as possible
     double targetFps = 60;
     double targetUps = 60;
+
+    // ticks run to catch up before a frame is rendered, a longer backlog
+    // is dropped so slow ticks cannot make the engine fall further behind
+    int maxTicksPerFrame = 5;
+
+    // the loop sleeps until this long before the next tick or frame and
+    // spins for the rest, raise it where the scheduler is coarse
+    double spinSeconds = 0.002;
+
+    // ticks back to back with a dt of 1 / targetUps instead of keeping
+    // up with the clock, and renders once after each tick
+    bool fixedStep = false;
+
+    // Updates on the job system while the main thread draws the state
+    // systems extracted after the previous tick, see
+    // EntitySystem::OnExtract. Application::Update then runs on another
+    // thread than Application::Render, and removed systems and unloaded
+    // scenes are deleted once no frame draws them. Queued events are
+    // dispatched by the ticks, so render code may only use
+    // EventManager::QueueEvent, not SendEvent, Subscribe or Unsubscribe.
+    bool pipelined = false;
+
+    // stops the engine after this many ticks, 0 runs until stopped
+    uint64 tickLimit = 0;
+
+    // threads used to update systems, negative picks from the hardware
+    int workerThreads = -1;
+
+    // logs through Logger's background thread while the engine runs
+    bool asyncLogging = false;
+
+    // frames longer than this count as hitches in the telemetry, 0 uses
+    // twice the target frame time, or 0.1 seconds without target rates
+    double hitchSeconds = 0;
+
+    // Bytes each memory tracker tag may use, by tag name such as
+    // "Textures" or the name of a component type. The engine warns once
+    // a second while a tag is over its budget, see MemoryTracker. Only
+    // builds with OASIS_TRACK_MEMORY count anything.
+    std::unordered_map<std::string, uint64> memoryBudgets;
+
+    // writes the engine's telemetry as JSON to this file when it stops
+    std::string telemetryReport;
+
+    // Records profile zones and writes them to this file as a Chrome
+    // trace when the engine stops. Empty records nothing, and zones are
+    // compiled out of release builds, see OASIS_PROFILE.
+    std::string profileTrace;
 };
 
 }
@@ -2,14 +2,22 @@
 
 #include "Oasis/Common.h"
 #include "Oasis/Core/Config.h" 
+#include "Oasis/Core/FrameArena.h" 
+
+#include <atomic> 
 
 namespace Oasis
 {
 
 class Application; 
 class Display; 
+class EventManager; 
 class GraphicsDevice; 
+class JobSystem; 
+class RenderState; 
+class RenderStateBuffer; 
 class SceneManager; 
+class Telemetry; 
 
 class OASIS_API Engine
 {
@@ -18,6 +26,13 @@ public:
     inline static GraphicsDevice* GetGraphicsDevice() { return graphics_; } 
     inline static Application* GetApplication() { return app_; } 
     inline static SceneManager* GetSceneManager() { return sceneManager_; } 
+    inline static JobSystem* GetJobSystem() { return jobSystem_; } 
+    inline static EventManager* GetEventManager() { return eventManager_; } 
+    inline static Telemetry* GetTelemetry() { return telemetry_; } 
+
+    // arena of the calling thread for data that lives until the end of
+    // the frame, the engine resets every thread's arena once per frame
+    inline static FrameArena& GetFrameArena() { return FrameArena::GetThreadArena(); } 
 
     static int Start(Application* app); 
     static void Stop(); 
@@ -25,11 +40,28 @@ public:
     inline static float GetFrameRate() { return fps_; }  
     inline static float GetUpdateRate() { return ups_; }  
 
+    // smoothed seconds between rendered frames
+    inline static float GetFrameTime() { return frameTime_; }  
+
     inline static bool IsRunning() { return running_; }  
 
+    // true when running without a display
+    inline static bool IsHeadless() { return display_ == nullptr; } 
+
+    inline static uint64 GetTotalTickCount() { return totalTicks_; } 
+
 private: 
     static int GameLoop(); 
 
+    // one update of the application and the scenes
+    static void Tick(float dt); 
+
+    // runs the ticks and extracts the active scene for the next frame
+    static void SimulatePipelined(int ticks, float dt); 
+
+    // draws the state, or the active scene if it is null
+    static void RenderFrame(const RenderState* state); 
+
     static void PreUpdate(float dt); 
     static void PostUpdate(float dt); 
 
@@ -41,11 +73,19 @@ private:
     static GraphicsDevice* graphics_; 
     static Application* app_; 
     static SceneManager* sceneManager_; 
-    
+    static JobSystem* jobSystem_; 
+    static EventManager* eventManager_; 
+    static Telemetry* telemetry_; 
+
+    // only when pipelined
+    static RenderStateBuffer* renderStates_; 
+
     // engine variables 
     static float fps_; 
     static float ups_; 
-    static bool running_; 
+    static float frameTime_; 
+    static std::atomic<bool> running_; 
+    static uint64 totalTicks_; 
     static Config config_; 
 }; 
 
@@ -0,0 +1,98 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+
+#include <type_traits> 
+
+namespace Oasis 
+{
+
+class OASIS_API Event {}; 
+
+class OASIS_API EventCallbackBase 
+{
+public: 
+    EventCallbackBase(int priority) : priority(priority) {} 
+    virtual ~EventCallbackBase() {} 
+
+    virtual void Invoke(Event*) = 0; 
+
+    // count events of the subscribed type, stride bytes apart
+    virtual void InvokeBatch(Event* events, uint32 count, uint32 stride) 
+    {
+        for (uint32 i = 0; i < count; i++) 
+        {
+            Invoke((Event*) ((uint8*) events + i * stride)); 
+        }
+    }
+
+    virtual bool Equals(EventCallbackBase* callback) const = 0; 
+
+    const int priority; 
+};
+
+template <class EventType, class Callee> 
+class OASIS_API ClassEventCallback : public EventCallbackBase 
+{
+public: 
+    static_assert(std::is_base_of<Event, EventType>::value, "Events must derive from Event"); 
+
+    using Callback = void (Callee::*)(EventType*); 
+
+    ClassEventCallback(Callee* callee, Callback callback, int priority) 
+        : EventCallbackBase(priority), callee_(callee), callback_(callback) {} 
+
+    void Invoke(Event* event) override 
+    {
+        if (callee_) (*callee_.*callback_)((EventType*) event); 
+    }
+
+    bool Equals(EventCallbackBase* callback) const override 
+    {
+        auto other = dynamic_cast<decltype(this)>(callback); 
+
+        return other && callee_ == other->callee_ && callback_ == other->callback_ && priority == other->priority; 
+    }
+
+private: 
+    Callee* callee_; 
+    Callback callback_; 
+};
+
+// Receives events as arrays, one per dispatch of the queued events,
+// or an array of one for events sent directly
+template <class EventType, class Callee> 
+class OASIS_API ClassBatchEventCallback : public EventCallbackBase 
+{
+public: 
+    static_assert(std::is_base_of<Event, EventType>::value, "Events must derive from Event"); 
+
+    using Callback = void (Callee::*)(const EventType*, uint32); 
+
+    ClassBatchEventCallback(Callee* callee, Callback callback, int priority) 
+        : EventCallbackBase(priority), callee_(callee), callback_(callback) {} 
+
+    void Invoke(Event* event) override 
+    {
+        if (callee_) (*callee_.*callback_)((const EventType*) event, 1); 
+    }
+
+    void InvokeBatch(Event* events, uint32 count, uint32 stride) override 
+    {
+        (void) stride; 
+        if (callee_) (*callee_.*callback_)((const EventType*) events, count); 
+    }
+
+    bool Equals(EventCallbackBase* callback) const override 
+    {
+        auto other = dynamic_cast<decltype(this)>(callback); 
+
+        return other && callee_ == other->callee_ && callback_ == other->callback_ && priority == other->priority; 
+    }
+
+private: 
+    Callee* callee_; 
+    Callback callback_; 
+};
+
+}
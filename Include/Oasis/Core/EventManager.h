@@ -1,84 +1,125 @@
 #pragma once 
 
 #include "Oasis/Common.h" 
+#include "Oasis/Core/Event.h" 
+#include "Oasis/Core/EventQueue.h" 
 
-#include <cstring> 
+#include <atomic> 
+#include <mutex> 
+#include <type_traits> 
+
+#ifndef OASIS_MAX_EVENT_TYPES 
+    #define OASIS_MAX_EVENT_TYPES 256 
+#endif 
 
 namespace Oasis
 {
 
-class OASIS_API Event {}; 
-
-class OASIS_API EventCallbackBase  
+// Delivers events to callbacks in priority order, lowest first. Events
+// can be sent, which calls the callbacks right away, or queued, which
+// copies the event into a lock-free queue of its type that is delivered
+// by DispatchQueuedEvents. Queuing is safe from any thread; everything
+// else, including dispatching, must happen on one thread at a time. The
+// engine dispatches after every tick, which runs on a job thread while
+// the main thread renders when Config::pipelined is set, and scenes
+// simulated by SceneManager::Simulate tick on several threads at once.
+// Callbacks may subscribe and unsubscribe while events are delivered,
+// the changes apply once delivery is done.
+class OASIS_API EventManager 
 {
 public: 
-    EventCallbackBase(int priority) : priority(priority) {} 
-    virtual ~EventCallbackBase() {} 
-
-    virtual void Invoke(Event*) = 0; 
-
-    virtual bool Equals(EventCallbackBase* callback) const = 0; 
+    template <class EventType, class Callee> 
+    using Callback = void (Callee::*)(EventType*); 
 
-    const int priority; 
-};
+    // fn(const EventType* events, uint32 count)
+    template <class EventType, class Callee> 
+    using BatchCallback = void (Callee::*)(const EventType*, uint32); 
 
-template <class EventType, class Callee> 
-class OASIS_API ClassEventCallback : public EventCallbackBase 
-{
-public: 
-    using Callback = void (Callee::*)(EventType*); 
+    EventManager(); 
+    ~EventManager(); 
 
-    ClassEventCallback(Callee* callee, Callback callback, int priority) 
-        : EventCallbackBase(priority), callee_(callee), callback_(callback) {} 
+    OASIS_NO_COPY(EventManager) 
 
-    void Invoke(Event* event) override
+    template <class EventType, class Callee> 
+    void Subscribe(Callee* callee, Callback<EventType, Callee> callbackFunction, int priority = 1000) 
     {
-        if (callee_) (*callee_.*callback_)((EventType*) event); 
+        Subscribe(GetClassId<EventType>(), new ClassEventCallback<EventType, Callee>(callee, callbackFunction, priority)); 
     }
 
-    bool Equals(EventCallbackBase* callback) const 
+    template <class EventType, class Callee> 
+    void Subscribe(Callee* callee, BatchCallback<EventType, Callee> callbackFunction, int priority = 1000) 
     {
-        auto other = (decltype(this)) callback; 
-
-        return callee_ == other->callee_ && callback_ == other->callback_ && priority == other->priority; 
+        Subscribe(GetClassId<EventType>(), new ClassBatchEventCallback<EventType, Callee>(callee, callbackFunction, priority)); 
     }
 
-private: 
-    Callee* callee_; 
-    Callback callback_; 
-};
-
-class OASIS_API EventManager 
-{
-public:
-    template <class EventType, class Callee> 
-    using Callback = void (Callee::*)(EventType*); 
-
     template <class EventType, class Callee> 
-    void Subscribe(Callee* callee, Callback<EventType, Callee> callbackFunction, int priority = 1000) 
+    bool Unsubscribe(Callee* callee, Callback<EventType, Callee> callbackFunction, int priority = 1000) 
     {
-        Subscribe(GetClassId<EventType>(), new ClassEventCallback<EventType, Callee>(callee, callbackFunction, priority)); 
-    } 
+        ClassEventCallback<EventType, Callee> callback(callee, callbackFunction, priority); 
+        return Unsubscribe(GetClassId<EventType>(), &callback); 
+    }
 
     template <class EventType, class Callee> 
-    bool Unsubscribe(Callee* callee, Callback<EventType, Callee> callbackFunction, int priority = 1000) 
+    bool Unsubscribe(Callee* callee, BatchCallback<EventType, Callee> callbackFunction, int priority = 1000) 
     {
-        ClassEventCallback<EventType, Callee> callback(callee, callbackFunction, priority); 
+        ClassBatchEventCallback<EventType, Callee> callback(callee, callbackFunction, priority); 
         return Unsubscribe(GetClassId<EventType>(), &callback); 
-    } 
+    }
 
     template <class EventType> void SendEvent(EventType* event) 
     {
+        static_assert(std::is_base_of<Event, EventType>::value, "Events must derive from Event"); 
+
         SendEvent(GetClassId<EventType>(), event); 
     }
 
+    // copies the event to be delivered by the next DispatchQueuedEvents,
+    // safe to call from any thread
+    template <class EventType> void QueueEvent(const EventType& event) 
+    {
+        GetQueue<EventType>().Push(event); 
+    }
+
+    // Delivers every queued event, each type as one array in the order
+    // of the event ClassIds. Events queued while dispatching are left
+    // for the next dispatch.
+    void DispatchQueuedEvents(); 
+
 private: 
-    void Subscribe(ClassId eventId, EventCallbackBase* callback);   
+    void Subscribe(ClassId eventId, EventCallbackBase* callback); 
     bool Unsubscribe(ClassId eventId, EventCallbackBase* callback); 
 
-    void SendEvent(ClassId eventId, Event* event);  
+    void SendEvent(ClassId eventId, Event* event); 
+
+    template <class EventType> 
+    EventQueue<EventType>& GetQueue() 
+    {
+        static_assert(std::is_base_of<Event, EventType>::value, "Events must derive from Event"); 
+
+        ClassId id = GetClassId<EventType>(); 
+        EventQueueBase* queue = id < OASIS_MAX_EVENT_TYPES ? queues_[id].load(std::memory_order_acquire) : nullptr; 
+
+        if (!queue) queue = AddQueue(id, new EventQueue<EventType>()); 
+
+        return *(EventQueue<EventType>*) queue; 
+    }
+
+    // returns the queue already added by another thread if there is one
+    EventQueueBase* AddQueue(ClassId eventId, EventQueueBase* queue); 
+
+    void BeginDelivery(); 
+    void EndDelivery(); 
+
+    // indexed by event ClassId
+    std::vector<std::vector<EventCallbackBase*>> callbacks_; 
+
+    std::atomic<EventQueueBase*> queues_[OASIS_MAX_EVENT_TYPES]; 
+    std::mutex queueMutex_; 
 
-    std::unordered_map<ClassId, std::vector<EventCallbackBase*>> callbacks_; 
+    // subscription changes made while delivering
+    uint32 delivering_ = 0; 
+    std::vector<std::pair<ClassId, EventCallbackBase*>> pendingAdds_; 
+    std::vector<EventCallbackBase*> pendingDeletes_; 
 };
 
-}
\ No newline at end of file
+}
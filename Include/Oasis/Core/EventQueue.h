@@ -0,0 +1,194 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+#include "Oasis/Core/Event.h" 
+
+#include <atomic> 
+#include <new> 
+#include <thread> 
+#include <type_traits> 
+
+namespace Oasis 
+{
+
+class OASIS_API EventQueueBase 
+{
+public: 
+    virtual ~EventQueueBase() {} 
+
+    // hands every queued event to the callbacks as one array, then
+    // destroys them, null callbacks are skipped
+    virtual void Dispatch(const std::vector<EventCallbackBase*>& callbacks) = 0; 
+};
+
+// Queue of one event type that any number of threads push to without
+// locking, drained by one thread at a time. Events are copied into one
+// of two buffers: a push reserves a slot in the active buffer with a
+// single atomic add, and a dispatch swaps buffers with a single
+// exchange, waits for pushes still writing to the old one and hands it
+// to the callbacks as an array. Pushes that do not fit go to a linked
+// list and the buffer is grown for the next time, so a steady event
+// rate does not allocate.
+template <class EventType> 
+class OASIS_API EventQueue : public EventQueueBase 
+{
+public: 
+    EventQueue() : state_(0), overflow_(nullptr), active_(0), wantedCapacity_(INITIAL_CAPACITY) 
+    {
+        for (uint32 i = 0; i < 2; i++) 
+        {
+            committed_[i] = 0; 
+            capacity_[i] = 0; 
+            data_[i] = nullptr; 
+            Grow(i, INITIAL_CAPACITY, 0); 
+        }
+    }
+
+    ~EventQueue() 
+    {
+        // undelivered events are destroyed
+        Dispatch(std::vector<EventCallbackBase*>()); 
+
+        delete[] data_[0]; 
+        delete[] data_[1]; 
+    }
+
+    OASIS_NO_COPY(EventQueue) 
+
+    // safe to call from any thread, also while dispatching
+    void Push(const EventType& event) 
+    {
+        uint64 state = state_.fetch_add(1, std::memory_order_acq_rel); 
+        uint32 buffer = (uint32) (state >> BUFFER_SHIFT); 
+        uint64 slot = state & COUNT_MASK; 
+
+        if (slot < capacity_[buffer]) 
+        {
+            new (&data_[buffer][slot]) EventType(event); 
+        }
+        else 
+        {
+            Node* node = new Node(event); 
+            node->next = overflow_.load(std::memory_order_relaxed); 
+
+            while (!overflow_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {} 
+        }
+
+        // the dispatch waits until every reserved slot is written
+        committed_[buffer].fetch_add(1, std::memory_order_release); 
+    }
+
+    // must not be called by two threads at once
+    void Dispatch(const std::vector<EventCallbackBase*>& callbacks) override 
+    {
+        uint32 buffer = active_; 
+        active_ = 1 - active_; 
+
+        uint64 reserved = state_.exchange((uint64) active_ << BUFFER_SHIFT, std::memory_order_acq_rel) & COUNT_MASK; 
+
+        while (committed_[buffer].load(std::memory_order_acquire) != reserved) 
+        {
+            std::this_thread::yield(); 
+        }
+        committed_[buffer].store(0, std::memory_order_relaxed); 
+
+        uint32 count = reserved < capacity_[buffer] ? (uint32) reserved : capacity_[buffer]; 
+
+        // may hold events pushed to the other buffer after the swap,
+        // they are complete and are delivered with this batch
+        Node* overflow = overflow_.exchange(nullptr, std::memory_order_acquire); 
+
+        if (overflow) count = AppendOverflow(buffer, count, overflow); 
+
+        EventType* events = (EventType*) data_[buffer]; 
+
+        for (auto callback : callbacks) 
+        {
+            if (callback && count) callback->InvokeBatch((Event*) events, count, sizeof (EventType)); 
+        }
+
+        for (uint32 i = 0; i < count; i++) 
+        {
+            events[i].~EventType(); 
+        }
+
+        // the other buffer may have overflowed before
+        if (capacity_[buffer] < wantedCapacity_) Grow(buffer, wantedCapacity_, 0); 
+    }
+
+private: 
+    using Storage = typename std::aligned_storage<sizeof (EventType), alignof (EventType)>::type; 
+
+    struct Node 
+    {
+        explicit Node(const EventType& event) : event(event) {} 
+
+        EventType event; 
+        Node* next = nullptr; 
+    };
+
+    static const uint32 INITIAL_CAPACITY = 64; 
+    static const uint32 BUFFER_SHIFT = 63; 
+    static const uint64 COUNT_MASK = ((uint64) 1 << BUFFER_SHIFT) - 1; 
+
+    // only called on a buffer no push is using, the first used slots hold events
+    void Grow(uint32 buffer, uint32 capacity, uint32 used) 
+    {
+        Storage* data = new Storage[capacity]; 
+
+        for (uint32 i = 0; i < used; i++) 
+        {
+            EventType* from = (EventType*) &data_[buffer][i]; 
+            new (&data[i]) EventType(std::move(*from)); 
+            from->~EventType(); 
+        }
+
+        delete[] data_[buffer]; 
+        data_[buffer] = data; 
+        capacity_[buffer] = capacity; 
+    }
+
+    // moves the overflow list behind the first count events, oldest first
+    uint32 AppendOverflow(uint32 buffer, uint32 count, Node* overflow) 
+    {
+        Node* reversed = nullptr; 
+        uint32 extra = 0; 
+
+        while (overflow) 
+        {
+            Node* next = overflow->next; 
+            overflow->next = reversed; 
+            reversed = overflow; 
+            overflow = next; 
+            extra++; 
+        }
+
+        while (wantedCapacity_ < count + extra) wantedCapacity_ *= 2; 
+
+        if (capacity_[buffer] < wantedCapacity_) Grow(buffer, wantedCapacity_, count); 
+
+        while (reversed) 
+        {
+            Node* next = reversed->next; 
+            new (&data_[buffer][count++]) EventType(std::move(reversed->event)); 
+            delete reversed; 
+            reversed = next; 
+        }
+
+        return count; 
+    }
+
+    // active buffer in the top bit, slots reserved in it below
+    std::atomic<uint64> state_; 
+    std::atomic<uint32> committed_[2]; 
+    std::atomic<Node*> overflow_; 
+
+    Storage* data_[2]; 
+    uint32 capacity_[2]; 
+
+    // owned by the dispatching thread
+    uint32 active_; 
+    uint32 wantedCapacity_; 
+};
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Oasis/Common.h"
+
+#include <cstddef>
+
+namespace Oasis
+{
+
+// Bump allocator for data that only lives until the end of the frame.
+// Every thread has its own, see Engine::GetFrameArena, and the engine resets
+// all of them once per loop, when no jobs are running. Freeing single
+// allocations does nothing. When a frame needed more than one block,
+// the next reset replaces them with a single block big enough for it,
+// so a steady frame does not call malloc.
+class OASIS_API FrameArena
+{
+public:
+    static const size_t DEFAULT_BLOCK_SIZE;
+
+    struct Marker
+    {
+        uint32 block;
+        size_t offset;
+    };
+
+    FrameArena();
+    ~FrameArena();
+
+    OASIS_NO_COPY(FrameArena)
+
+    // arena of the calling thread
+    static FrameArena& GetThreadArena();
+
+    // resets the arena of every thread, no thread may be using its arena
+    static void ResetAll();
+
+    void* Allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    template <class T>
+    inline T* Allocate(size_t count)
+    {
+        return static_cast<T*>(Allocate(count * sizeof (T), alignof(T)));
+    }
+
+    void Reset();
+
+    // Rewind frees everything allocated after the marker was taken,
+    // allocations made before it stay valid.
+    Marker GetMarker() const;
+    void Rewind(const Marker& marker);
+
+    // bytes handed out since the last reset, including alignment
+    size_t GetUsed() const;
+
+    // most bytes used at a reset or rewind
+    inline size_t GetHighWater() const { return highWater_; }
+
+    size_t GetCapacity() const;
+
+private:
+    struct Block
+    {
+        char* data;
+        size_t size;
+    };
+
+    void FreeBlocks();
+
+    std::vector<Block> blocks_;
+    uint32 block_ = 0;
+    size_t offset_ = 0;
+
+    size_t highWater_ = 0;
+};
+
+// Rewinds the calling thread's arena when it goes out of scope, for
+// temporary data that does not need to live until the end of the frame.
+// Must not enclose code that keeps arena allocations for the frame.
+class OASIS_API FrameArenaScope
+{
+public:
+    inline FrameArenaScope()
+        : arena_(FrameArena::GetThreadArena()), marker_(arena_.GetMarker()) {}
+
+    inline ~FrameArenaScope() { arena_.Rewind(marker_); }
+
+    OASIS_NO_COPY(FrameArenaScope)
+
+private:
+    FrameArena& arena_;
+    FrameArena::Marker marker_;
+};
+
+// STL allocator over a frame arena, the arena of the constructing thread
+// by default. Containers using it must only grow on that thread and must
+// not outlive the frame or the enclosing FrameArenaScope.
+template <class T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    inline FrameAllocator() : arena_(&FrameArena::GetThreadArena()) {}
+    inline explicit FrameAllocator(FrameArena& arena) : arena_(&arena) {}
+
+    template <class U>
+    inline FrameAllocator(const FrameAllocator<U>& other) : arena_(other.GetArena()) {}
+
+    inline T* allocate(size_t count) { return arena_->Allocate<T>(count); }
+    inline void deallocate(T* ptr, size_t count) { (void) ptr; (void) count; }
+
+    inline FrameArena* GetArena() const { return arena_; }
+
+    template <class U>
+    inline bool operator==(const FrameAllocator<U>& other) const { return arena_ == other.GetArena(); }
+
+    template <class U>
+    inline bool operator!=(const FrameAllocator<U>& other) const { return arena_ != other.GetArena(); }
+
+private:
+    FrameArena* arena_;
+};
+
+template <class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Oasis/Common.h"
+
+namespace Oasis
+{
+
+// Decides when the game loop ticks and renders, and sleeps until the
+// next of them is due instead of spinning. Ticks follow the monotonic
+// clock at a fixed rate. Frames are limited to a target rate and keep
+// their cadence when a frame is slightly late.
+class OASIS_API FramePacer
+{
+public:
+    // targetUps must be positive, a targetFps of 0 does not limit frames
+    FramePacer(double targetUps, double targetFps);
+
+    // At most this many ticks run before a frame, a longer backlog is
+    // dropped so that slow ticks cannot make the loop fall further behind.
+    inline void SetMaxTicks(int maxTicks) { maxTicks_ = maxTicks > 0 ? maxTicks : 1; }
+
+    // Waiting sleeps until this long before a deadline and spins for the
+    // rest. Longer is more precise, but uses more CPU.
+    inline void SetSpinTime(double seconds) { spinTime_ = seconds > 0 ? seconds : 0; }
+
+    // weight of the newest frame in the smoothed frame time
+    inline void SetSmoothing(double smoothing) { smoothing_ = smoothing; }
+
+    // number of ticks due since the last call, at most the max ticks
+    int TakeTicks();
+
+    bool IsFrameDue() const;
+
+    // call once a frame was rendered
+    void FrameRendered();
+
+    // sleeps until the next tick, or the next frame if frames are limited
+    void Wait();
+
+    // seconds since the pacer was created
+    double GetTime() const;
+
+    // smoothed seconds between rendered frames, 0 before the second frame
+    inline double GetFrameTime() const { return frameTime_; }
+
+    // seconds between the last two rendered frames, 0 before the second frame
+    inline double GetLastFrameTime() const { return lastFrameTime_; }
+
+    // ticks skipped because the loop fell behind
+    inline uint64 GetDroppedTicks() const { return droppedTicks_; }
+
+private:
+    void WaitUntil(double time);
+
+    uint64 start_;
+
+    double tickInterval_;
+    double frameInterval_;
+    double nextTick_;
+    double nextFrame_;
+
+    int maxTicks_ = 5;
+    double spinTime_ = 0.002;
+    double smoothing_ = 0.1;
+
+    double lastFrame_ = -1;
+    double frameTime_ = 0;
+    double lastFrameTime_ = 0;
+    uint64 droppedTicks_ = 0;
+};
+
+}
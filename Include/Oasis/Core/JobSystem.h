@@ -0,0 +1,130 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+
+#include <atomic> 
+#include <condition_variable> 
+#include <deque> 
+#include <functional> 
+#include <mutex> 
+#include <thread> 
+
+namespace Oasis 
+{
+
+class JobSystem; 
+
+// Number of scheduled jobs that have not finished yet. Jobs can be
+// scheduled to start only once a counter reaches zero. A counter must
+// not be destroyed before it is done.
+class OASIS_API JobCounter 
+{
+public: 
+    JobCounter() : count_(0) {} 
+
+    // the job that finished the count may still be releasing it
+    ~JobCounter() { std::lock_guard<std::mutex> lock(mutex_); } 
+
+    OASIS_NO_COPY(JobCounter) 
+
+    inline bool IsDone() const { return count_.load() == 0; } 
+
+private: 
+    friend class JobSystem; 
+
+    struct Dependent 
+    {
+        JobSystem* system; 
+        std::function<void()> job; 
+        JobCounter* counter; 
+    };
+
+    std::atomic<uint32> count_; 
+
+    // jobs waiting for this counter to reach zero
+    std::mutex mutex_; 
+    std::vector<Dependent> dependents_; 
+};
+
+// Runs jobs on a fixed set of worker threads. Every worker has its own
+// deque, it runs the newest job it scheduled first and steals the
+// oldest job of another queue when its own is empty. A thread waiting
+// on a counter runs jobs itself, so waiting from inside a job does not
+// deadlock and a job system without workers still makes progress.
+class OASIS_API JobSystem 
+{
+public: 
+    using Job = std::function<void()>; 
+
+    // fn(uint32 begin, uint32 end)
+    using RangeJob = std::function<void(uint32, uint32)>; 
+
+    // one worker less than the hardware threads, the
+    // thread that waits on jobs takes the remaining one
+    static uint32 GetDefaultWorkerCount(); 
+
+    JobSystem(); 
+    explicit JobSystem(uint32 workerCount); 
+    ~JobSystem(); 
+
+    OASIS_NO_COPY(JobSystem) 
+
+    inline uint32 GetWorkerCount() const { return workers_.size(); } 
+
+    // the counter is incremented now and decremented when the job finishes
+    void Schedule(const Job& job, JobCounter* counter = nullptr); 
+
+    // same as Schedule, but the job only starts once dependency is done
+    void Schedule(const Job& job, JobCounter* counter, JobCounter& dependency); 
+
+    // runs jobs on the calling thread until the counter reaches zero
+    void Wait(JobCounter& counter); 
+
+    // range size that splits count items into a few ranges per thread,
+    // rounded to whole cache lines of items of the given size
+    uint32 GetGrainSize(uint32 count, uint32 itemSize = 4) const; 
+
+    // Calls fn over [0, count) split into ranges of at most grainSize
+    // items (0 picks one with GetGrainSize), and returns once every
+    // range is done. The calling thread runs ranges too.
+    void ParallelFor(uint32 count, const RangeJob& fn, uint32 grainSize = 0); 
+
+private: 
+    struct QueuedJob 
+    {
+        Job job; 
+        JobCounter* counter; 
+    };
+
+    struct WorkQueue 
+    {
+        std::mutex mutex; 
+        std::deque<QueuedJob> jobs; 
+    };
+
+    void StartWorkers(uint32 workerCount); 
+    void WorkerLoop(uint32 queue); 
+
+    // queue owned by the calling thread, threads that
+    // are not workers share the external queue 0
+    uint32 GetThreadQueue() const; 
+
+    void Push(QueuedJob job); 
+
+    // runs one job from the thread's own queue or stolen
+    // from another, false if every queue was empty
+    bool RunJob(uint32 queue); 
+    void Finish(JobCounter* counter); 
+
+    std::vector<std::thread> workers_; 
+    std::vector<WorkQueue*> queues_; 
+
+    // jobs in all queues, workers sleep while there are none
+    std::atomic<uint32> queued_; 
+    std::atomic<uint32> sleeping_; 
+    std::mutex sleepMutex_; 
+    std::condition_variable wake_; 
+    std::atomic<bool> stopping_; 
+};
+
+}
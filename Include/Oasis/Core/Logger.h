@@ -2,11 +2,24 @@
 
 #include "Oasis/Common.h" 
 
+#include <atomic> 
+#include <cstring> 
 #include <ostream> 
 #include <sstream> 
+#include <type_traits> 
+
+// Messages above this level are compiled out, their arguments are still 
+// evaluated. Defaults to INFO (3) in release builds and FINE (5) otherwise. 
+#ifndef OASIS_LOG_LEVEL 
+    #ifdef NDEBUG 
+        #define OASIS_LOG_LEVEL 3 
+    #else 
+        #define OASIS_LOG_LEVEL 5 
+    #endif 
+#endif 
 
 #define OASIS_LOG_TYPE(function, level) \
-    template <class First, class... Rest> inline static bool function (First value, Rest... rest) { return Log(level, value, rest...); } 
+    template <class First, class... Rest> inline static bool function (const First& value, const Rest&... rest) { return Log(level, value, rest...); } 
 
 namespace Oasis 
 {
@@ -37,16 +50,117 @@ inline const char* GetLogLevelName(LogLevel level)
     }
 }
 
+// Writes the arguments of one message into a log record. Numbers, 
+// strings and pointers are stored as they are and formatted later, 
+// other types are formatted with operator<< straight into the record. 
+// Arguments that do not fit in the record are left out. 
+class OASIS_API LogRecordWriter 
+{
+public: 
+    enum Tag : uint8 
+    {
+        INT = 0, 
+        UINT = 1, 
+        DOUBLE = 2, 
+        BOOL = 3, 
+        CHAR = 4, 
+        STRING = 5, 
+        POINTER = 6, 
+    }; 
+
+    inline LogRecordWriter(char* begin, char* end) : pos_(begin), end_(end) {} 
+
+    inline char* GetPosition() const { return pos_; } 
+
+    inline void Write(bool value) { Put(BOOL, &value, sizeof (value)); } 
+    inline void Write(char value) { Put(CHAR, &value, sizeof (value)); } 
+    inline void Write(signed char value) { Write(static_cast<char>(value)); } 
+    inline void Write(unsigned char value) { Write(static_cast<char>(value)); } 
+
+    inline void Write(const char* value) { WriteString(value, std::strlen(value)); } 
+    inline void Write(char* value) { Write(static_cast<const char*>(value)); } 
+    inline void Write(const std::string& value) { WriteString(value.data(), value.size()); } 
+
+    // streams print these as strings as well
+    inline void Write(const unsigned char* value) { Write(reinterpret_cast<const char*>(value)); } 
+    inline void Write(unsigned char* value) { Write(reinterpret_cast<const char*>(value)); } 
+    inline void Write(const signed char* value) { Write(reinterpret_cast<const char*>(value)); } 
+    inline void Write(signed char* value) { Write(reinterpret_cast<const char*>(value)); } 
+
+    template <class T> 
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type Write(T value) 
+    {
+        int64 v = value; 
+        Put(INT, &v, sizeof (v)); 
+    }
+
+    template <class T> 
+    typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type Write(T value) 
+    {
+        uint64 v = value; 
+        Put(UINT, &v, sizeof (v)); 
+    }
+
+    template <class T> 
+    typename std::enable_if<std::is_floating_point<T>::value>::type Write(T value) 
+    {
+        double v = value; 
+        Put(DOUBLE, &v, sizeof (v)); 
+    }
+
+    template <class T> 
+    void Write(T* value) 
+    {
+        const void* v = value; 
+        Put(POINTER, &v, sizeof (v)); 
+    }
+
+    template <class T> 
+    typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_pointer<T>::value>::type Write(const T& value) 
+    {
+        // tag and length are filled in once the size is known 
+        if (end_ - pos_ < 5) return; 
+
+        std::ostream& out = BeginFormat(pos_ + 5, end_); 
+        out << value; 
+        WriteStringHeader(EndFormat()); 
+    }
+
+private: 
+    void Put(Tag tag, const void* data, uint32 size); 
+    void WriteString(const char* data, size_t size); 
+    void WriteStringHeader(uint32 size); 
+
+    // stream writing to [begin, end) that drops what does not fit 
+    static std::ostream& BeginFormat(char* begin, char* end); 
+    static uint32 EndFormat(); 
+
+    char* pos_; 
+    char* end_; 
+};
+
 class OASIS_API Logger 
 {
 public: 
     static void SetOutput(std::ostream* out); 
+    static std::ostream* GetOutput() { return out_; } 
 
     static LogLevel GetLevel() { return level_; } 
     static void SetLevel(LogLevel level); 
 
+    // Async messages are written to a ring buffer of the calling thread 
+    // without allocating, and formatted and written to the output by a 
+    // background thread, in the order they were begun across threads. 
+    // Messages are flushed in batches, fatal ones right away. Switch 
+    // only while no other thread is logging. 
+    static void SetAsync(bool async); 
+    static bool IsAsync() { return async_; } 
+
+    // returns once the messages logged so far have been written 
+    static void Flush(); 
+
     template <class First, class... Rest> 
-    static bool Log(LogLevel level, First message, Rest... rest); 
+    static bool Log(LogLevel level, const First& message, const Rest&... rest); 
 
     OASIS_LOG_TYPE(Fatal, LogLevel::FATAL) 
     OASIS_LOG_TYPE(Error, LogLevel::ERROR) 
@@ -60,28 +174,51 @@ private:
     ~Logger() = delete; 
 
     template <class First, class... Rest> 
-    static void BuildString(std::stringstream& out, First first, Rest... rest); 
+    static void BuildString(std::stringstream& out, const First& first, const Rest&... rest); 
     static void BuildString(std::stringstream& out) { (void) out; } 
 
+    template <class First, class... Rest> 
+    static void WriteArgs(LogRecordWriter& out, const First& first, const Rest&... rest); 
+    static void WriteArgs(LogRecordWriter& out) { (void) out; } 
+
+    // space for one record in the calling thread's ring buffer, 
+    // waits while the background thread catches up 
+    static LogRecordWriter BeginRecord(); 
+    static void EndRecord(LogLevel level, const LogRecordWriter& writer); 
+
+    static void WriteSync(LogLevel level, const std::string& message); 
+
     static std::ostream* out_; 
     static LogLevel level_; 
+    static std::atomic<bool> async_; 
 };
 
 template <class First, class... Rest> 
-bool Logger::Log(LogLevel level, First first, Rest... rest) 
+bool Logger::Log(LogLevel level, const First& first, const Rest&... rest) 
 {
+    // constant in the level functions, so the rest is compiled out 
+    if (static_cast<int>(level) > OASIS_LOG_LEVEL) return false; 
+
     if (level > level_ || !out_) return false; 
 
+    if (async_.load(std::memory_order_relaxed)) 
+    {
+        LogRecordWriter writer = BeginRecord(); 
+        WriteArgs(writer, first, rest...); 
+        EndRecord(level, writer); 
+        return true; 
+    }
+
     std::stringstream out; 
     BuildString(out, first, rest...); 
 
-    (*out_) << GetLogLevelName(level) << out.str() << std::endl; 
+    WriteSync(level, out.str()); 
 
     return true; 
 }
 
 template <class First, class... Rest> 
-void Logger::BuildString(std::stringstream& out, First first, Rest... rest) 
+void Logger::BuildString(std::stringstream& out, const First& first, const Rest&... rest) 
 {
     out << first; 
 
@@ -89,6 +226,17 @@ void Logger::BuildString(std::stringstream& out, First first, Rest... rest)
     {
         BuildString(out, rest...); 
     }
-} 
+}
+
+template <class First, class... Rest> 
+void Logger::WriteArgs(LogRecordWriter& out, const First& first, const Rest&... rest) 
+{
+    out.Write(first); 
 
-}
\ No newline at end of file
+    if (sizeof... (Rest)) 
+    {
+        WriteArgs(out, rest...); 
+    }
+}
+
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Oasis/Common.h"
+
+#include <memory>
+
+namespace Oasis
+{
+
+struct OASIS_API MemoryStats
+{
+    // bytes allocated now and the most there ever were
+    uint64 bytes = 0;
+    uint64 highWater = 0;
+
+    // allocations not freed yet, and made in total
+    uint64 liveAllocations = 0;
+    uint64 allocations = 0;
+
+    // 0 when the tag has no budget, always 0 in the totals
+    uint64 budget = 0;
+};
+
+// Counts the memory of the engine's subsystems by tag. Tags can have a
+// parent, whose counters include the ones of its children, for example
+// every component type has a tag below COMPONENTS. Counting is lock
+// free, registering tags and checking budgets take a lock. Whether
+// anything is counted is decided when the engine is built, with the
+// OASIS_TRACK_MEMORY CMake option, so code using the engine always
+// agrees with it whatever its own flags are.
+class OASIS_API MemoryTracker
+{
+public:
+    static const uint32 MAX_TAGS = 256;
+    static const uint32 NO_TAG = 0xFFFFFFFF;
+
+    // tags that always exist, RegisterTag adds more
+    enum Tag : uint32
+    {
+        // tags past MAX_TAGS are counted here
+        OTHER = 0,
+        COMPONENTS = 1,
+        ARCHETYPES = 2,
+        MESHES = 3,
+        BUFFERS = 4,
+        TEXTURES = 5,
+        SHADERS = 6,
+        FRAME_ARENA = 7,
+
+        BUILTIN_TAG_COUNT = 8,
+    };
+
+    static bool IsEnabled();
+
+    // returns the tag with the name, adding it if it does not exist yet
+    static uint32 RegisterTag(const std::string& name, uint32 parent = NO_TAG);
+
+    // NO_TAG if there is no tag with the name
+    static uint32 FindTag(const std::string& name);
+
+    static uint32 GetTagCount();
+    static std::string GetTagName(uint32 tag);
+    static uint32 GetParent(uint32 tag);
+
+    // do nothing unless the engine was built to track memory
+    static void Allocated(uint32 tag, size_t bytes);
+    static void Freed(uint32 tag, size_t bytes);
+
+    static MemoryStats GetStats(uint32 tag);
+
+    // every tag without a parent together
+    static MemoryStats GetTotalStats();
+
+    // high-water marks start again from the current bytes
+    static void ResetHighWater();
+
+    // CheckBudgets warns when a tag uses more than this, 0 removes it
+    static void SetBudget(uint32 tag, uint64 bytes);
+
+    // Logs a warning for every tag that went over its budget since the
+    // last check, and returns how many tags are over budget now.
+    static uint32 CheckBudgets();
+
+private:
+    MemoryTracker() = delete;
+    ~MemoryTracker() = delete;
+
+    static void Count(uint32 tag, int64 bytes, int64 allocations);
+};
+
+// STL allocator that counts its memory under a tag that always exists.
+template <class T, uint32 Tag>
+class TrackedAllocator
+{
+public:
+    using value_type = T;
+
+    template <class U>
+    struct rebind
+    {
+        using other = TrackedAllocator<U, Tag>;
+    };
+
+    inline TrackedAllocator() {}
+
+    template <class U>
+    inline TrackedAllocator(const TrackedAllocator<U, Tag>& other) { (void) other; }
+
+    inline T* allocate(size_t count)
+    {
+        T* ptr = std::allocator<T>().allocate(count);
+        MemoryTracker::Allocated(Tag, count * sizeof (T));
+        return ptr;
+    }
+
+    inline void deallocate(T* ptr, size_t count)
+    {
+        MemoryTracker::Freed(Tag, count * sizeof (T));
+        std::allocator<T>().deallocate(ptr, count);
+    }
+
+    template <class U>
+    inline bool operator==(const TrackedAllocator<U, Tag>& other) const { (void) other; return true; }
+
+    template <class U>
+    inline bool operator!=(const TrackedAllocator<U, Tag>& other) const { (void) other; return false; }
+};
+
+// the same types in every build, so classes using them do not
+// change with OASIS_TRACK_MEMORY
+template <class T, uint32 Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
+
+template <class Key, class Value, uint32 Tag>
+using TrackedMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>, TrackedAllocator<std::pair<const Key, Value>, Tag>>;
+
+}
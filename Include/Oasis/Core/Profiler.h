@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Oasis/Common.h"
+
+// Zones are compiled in unless OASIS_PROFILE is 0, which is the default
+// for release builds. Without them the macros below expand to nothing.
+#ifndef OASIS_PROFILE
+    #ifdef NDEBUG
+        #define OASIS_PROFILE 0
+    #else
+        #define OASIS_PROFILE 1
+    #endif
+#endif
+
+#define OASIS_PROFILE_CONCAT_(a, b) a##b
+#define OASIS_PROFILE_CONCAT(a, b) OASIS_PROFILE_CONCAT_(a, b)
+
+#if OASIS_PROFILE
+    // times the rest of the enclosing scope, name must outlive the
+    // profile, e.g. a string literal or Profiler::Intern
+    #define OASIS_PROFILE_ZONE(name) ::Oasis::ProfileZone OASIS_PROFILE_CONCAT(oasisProfileZone, __LINE__)(name)
+
+    // name of the calling thread in exported traces
+    #define OASIS_PROFILE_THREAD(name) ::Oasis::Profiler::SetThreadName(name)
+#else
+    #define OASIS_PROFILE_ZONE(name)
+    #define OASIS_PROFILE_THREAD(name)
+#endif
+
+namespace Oasis
+{
+
+struct OASIS_API ProfileEvent
+{
+    const char* name;
+
+    // nanoseconds since the profiler started
+    uint64 start;
+    uint64 end;
+
+    // zones open around this one on the same thread
+    uint32 depth;
+};
+
+// Records nested zones per thread. Every thread writes to its own ring
+// buffer without locking, so once a thread recorded EVENTS_PER_THREAD
+// zones its oldest ones are overwritten. Recording is off until enabled.
+class OASIS_API Profiler
+{
+public:
+    static const uint32 EVENTS_PER_THREAD;
+
+    // deepest zone recorded, deeper ones are ignored
+    static const uint32 MAX_DEPTH;
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    // false if the zone is not recorded and must not be ended
+    static bool BeginZone(const char* name);
+    static void EndZone();
+
+    static void SetThreadName(const std::string& name);
+
+    // copy of the name that lives until the program exits
+    static const char* Intern(const std::string& name);
+
+    // Writes the recorded zones of every thread in the Chrome trace event
+    // format, which chrome://tracing and Perfetto open. Zones still being
+    // recorded while it runs may be missing or torn.
+    static bool WriteChromeTrace(const std::string& path);
+
+    // forgets recorded zones, no zones may be open on any thread
+    static void Clear();
+
+private:
+    Profiler() = delete;
+    ~Profiler() = delete;
+};
+
+class OASIS_API ProfileZone
+{
+public:
+    inline explicit ProfileZone(const char* name)
+        : recorded_(Profiler::BeginZone(name)) {}
+
+    inline ~ProfileZone()
+    {
+        if (recorded_) Profiler::EndZone();
+    }
+
+    OASIS_NO_COPY(ProfileZone)
+
+private:
+    bool recorded_;
+};
+
+}
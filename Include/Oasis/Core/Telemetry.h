@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Oasis/Common.h"
+
+#include <mutex>
+
+namespace Oasis
+{
+
+class SceneManager;
+
+struct OASIS_API TimeStats
+{
+    // seconds
+    double average = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double max = 0;
+
+    uint32 samples = 0;
+};
+
+// Keeps the most recent durations, older ones are overwritten.
+// Percentiles are computed from a sorted copy when asked for.
+class OASIS_API TimeWindow
+{
+public:
+    explicit TimeWindow(uint32 capacity);
+
+    void Add(double seconds);
+
+    TimeStats GetStats() const;
+
+    void Clear();
+
+private:
+    std::vector<double> samples_;
+    uint32 next_ = 0;
+    uint32 count_ = 0;
+};
+
+// Exponential moving average of a duration, cheap enough to keep per
+// system. Only the thread that adds to it may read it without tearing.
+struct OASIS_API AverageTime
+{
+    double seconds = 0;
+    uint64 samples = 0;
+
+    inline void Add(double time)
+    {
+        seconds = samples++ ? seconds + (time - seconds) * 0.05 : time;
+    }
+};
+
+// Frame, update and render times of the engine over the last frames,
+// plus counters. Safe to record to and query from any thread.
+class OASIS_API Telemetry
+{
+public:
+    // frames longer than hitchSeconds count as hitches
+    Telemetry(double hitchSeconds, uint32 windowSize = 600);
+
+    void AddFrame(double seconds, uint32 drawCalls);
+    void AddUpdate(double seconds);
+    void AddRender(double seconds);
+    void SetEntityCount(uint64 count);
+
+    TimeStats GetFrameStats() const;
+    TimeStats GetUpdateStats() const;
+    TimeStats GetRenderStats() const;
+
+    inline double GetHitchSeconds() const { return hitchSeconds_; }
+
+    uint64 GetFrameCount() const;
+    uint64 GetHitchCount() const;
+
+    // draw calls of the last frame and of every frame
+    uint32 GetDrawCalls() const;
+    uint64 GetTotalDrawCalls() const;
+
+    // entities in every scene after the last tick
+    uint64 GetEntityCount() const;
+
+    // Writes the statistics as JSON, with the average times of every
+    // system in the scenes if they are given. The scenes must not be
+    // updating while it runs.
+    bool WriteReport(const std::string& path, SceneManager* scenes = nullptr) const;
+
+    void Clear();
+
+private:
+    mutable std::mutex mutex_;
+
+    double hitchSeconds_;
+
+    TimeWindow frames_;
+    TimeWindow updates_;
+    TimeWindow renders_;
+
+    uint64 frameCount_ = 0;
+    uint64 hitchCount_ = 0;
+    uint32 drawCalls_ = 0;
+    uint64 totalDrawCalls_ = 0;
+    uint64 entityCount_ = 0;
+};
+
+}
@@ -16,6 +16,12 @@ OASIS_API uint64_t Millis();
 
 OASIS_API void Sleep(uint64_t millis);
 
+// monotonic, only differences between calls are meaningful
+OASIS_API uint64_t Nanos();
+
+// may wake up late by the scheduler's granularity
+OASIS_API void SleepNanos(uint64_t nanos);
+
 }
 
 }
@@ -11,6 +11,7 @@
 namespace Oasis
 {
 
+// Measures wall time from a monotonic clock
 class OASIS_API Timer
 {
 public:
@@ -66,6 +66,12 @@ public:
 
     virtual RenderTexture2D* CreateRenderTexture2D(TextureFormat format, int width, int height, int multisamples = 1) = 0; 
 
+    // draw calls made since the last frame started
+    inline uint32 GetDrawCount() const { return drawCount_; } 
+
+protected: 
+    uint32 drawCount_ = 0; 
+
 private: 
     friend class Engine; 
 
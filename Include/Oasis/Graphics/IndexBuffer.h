@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Oasis/Common.h"
+#include "Oasis/Core/MemoryTracker.h"
 
 #include "Oasis/Graphics/Types.h" 
 
@@ -30,7 +31,7 @@ protected:
     virtual void UploadToGPU() = 0; 
 
     BufferUsage usage_; 
-    std::vector<short> data_;
+    TrackedVector<short, MemoryTracker::BUFFERS> data_;
     bool dirty_ = true;
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Oasis/Common.h"
+#include "Oasis/Core/MemoryTracker.h"
 #include "Oasis/Graphics/GraphicsDevice.h"
 
 #include <vector>
@@ -16,7 +17,7 @@ struct OASIS_API Submesh
     bool dirty = true;
     IndexBuffer* indexBuffer = nullptr;
     Primitive primitive = Primitive::TRIANGLE_LIST;
-    std::vector<short> indices;
+    TrackedVector<short, MemoryTracker::MESHES> indices;
 };
 
 class OASIS_API Mesh : public Object 
@@ -68,10 +69,10 @@ private:
 
     bool verticesDirty_ = true;
     int vertexCount_ = 0;
-    std::vector<Vector3> positions_;
-    std::vector<Vector3> normals_;
-    std::vector<Vector2> texCoords_;
-    std::vector<Vector3> tangents_;
+    TrackedVector<Vector3, MemoryTracker::MESHES> positions_;
+    TrackedVector<Vector3, MemoryTracker::MESHES> normals_;
+    TrackedVector<Vector2, MemoryTracker::MESHES> texCoords_;
+    TrackedVector<Vector3, MemoryTracker::MESHES> tangents_;
     VertexBuffer* vertexBuffer_ = nullptr;
 
     std::vector<Submesh> submeshes_;
@@ -0,0 +1,93 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+#include "Oasis/Math/Matrix4.h" 
+
+#include <vector> 
+
+namespace Oasis 
+{
+
+class EntitySystem; 
+class Material; 
+class Mesh; 
+class Scene; 
+
+struct OASIS_API RenderItem 
+{
+    Matrix4 model; 
+    Mesh* mesh; 
+    Material* material; 
+};
+
+// What a scene looked like after one tick, as far as drawing it goes.
+// Systems fill it in OnExtract and draw it in OnDraw, so it can be drawn
+// while the scene is already updating the next tick. Meshes and
+// materials are referenced, not copied, and must stay alive until the
+// state is drawn.
+class OASIS_API RenderState 
+{
+public: 
+    inline void Clear() 
+    {
+        scene_ = nullptr; 
+        tick_ = 0; 
+        systems_.clear(); 
+        items_.clear(); 
+    }
+
+    inline void Begin(Scene* scene) 
+    {
+        Clear(); 
+        scene_ = scene; 
+    }
+
+    // scene the state was extracted from, null if it is empty
+    inline Scene* GetScene() const { return scene_; } 
+
+    // engine tick the state was extracted after
+    inline uint64 GetTick() const { return tick_; } 
+    inline void SetTick(uint64 tick) { tick_ = tick; } 
+
+    // systems that extracted to the state, in the order they draw it
+    inline void AddSystem(EntitySystem* system) { systems_.push_back(system); } 
+    inline const std::vector<EntitySystem*>& GetSystems() const { return systems_; } 
+
+    inline void AddMesh(const Matrix4& model, Mesh* mesh, Material* material = nullptr) 
+    {
+        items_.push_back({ model, mesh, material }); 
+    }
+
+    inline const std::vector<RenderItem>& GetItems() const { return items_; } 
+
+private: 
+    Scene* scene_ = nullptr; 
+    uint64 tick_ = 0; 
+    std::vector<EntitySystem*> systems_; 
+
+    // kept between ticks so a steady scene does not allocate
+    std::vector<RenderItem> items_; 
+};
+
+// Two render states, one written by the simulation while the other is
+// drawn. Swap is called once both are done with their state.
+class OASIS_API RenderStateBuffer 
+{
+public: 
+    inline RenderState& GetWriteState() { return states_[1 - read_]; } 
+    inline const RenderState& GetReadState() const { return states_[read_]; } 
+
+    inline void Swap() { read_ = 1 - read_; } 
+
+    inline void Clear() 
+    {
+        states_[0].Clear(); 
+        states_[1].Clear(); 
+    }
+
+private: 
+    RenderState states_[2]; 
+    uint32 read_ = 0; 
+};
+
+}
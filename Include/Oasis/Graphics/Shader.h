@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Oasis/Common.h"
+#include "Oasis/Core/MemoryTracker.h" 
 #include "Oasis/Graphics/Parameter.h" 
 #include "Oasis/Graphics/Types.h" 
 #include "Oasis/Math/MathUtil.h" 
@@ -82,7 +83,7 @@ protected:
     std::string errorMessage_ = ""; 
     std::string vSource_; 
     std::string fSource_; 
-    std::unordered_map<std::string, ShaderParameter> parameters_; 
+    TrackedMap<std::string, ShaderParameter, MemoryTracker::SHADERS> parameters_; 
     std::unordered_set<std::string> updateParameters_; 
 };
 
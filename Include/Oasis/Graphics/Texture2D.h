@@ -1,5 +1,6 @@
 #pragma once 
 
+#include "Oasis/Core/MemoryTracker.h" 
 #include "Oasis/Graphics/Texture.h" 
 
 namespace Oasis 
@@ -22,7 +23,7 @@ public:
     void SetData(int x, int y, int width, int height, const void* in); 
 
 protected: 
-    std::vector<char> data_; 
+    TrackedVector<char, MemoryTracker::TEXTURES> data_; 
     int mipmaps_ = 1; 
 };
 
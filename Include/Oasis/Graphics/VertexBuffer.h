@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Oasis/Common.h"
+#include "Oasis/Core/MemoryTracker.h"
 
 #include "Oasis/Graphics/VertexFormat.h"
 
@@ -30,7 +31,7 @@ protected:
 
     BufferUsage usage_; 
     VertexFormat format_;
-    std::vector<float> data_;
+    TrackedVector<float, MemoryTracker::BUFFERS> data_;
     bool dirty_ = true;
 };
 
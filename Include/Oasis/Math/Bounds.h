@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Oasis/Common.h"
+#include "Oasis/Math/Vector3.h"
+#include "Oasis/Math/Vector4.h"
+#include "Oasis/Math/Matrix4.h"
+
+#include <utility>
+
+namespace Oasis
+{
+
+// Axis aligned bounding box
+struct OASIS_API Aabb
+{
+    Vector3 min;
+    Vector3 max;
+
+    Aabb() {}
+
+    Aabb(const Vector3& min, const Vector3& max) : min(min), max(max) {}
+
+    static Aabb FromCenter(const Vector3& center, const Vector3& extents) { return Aabb(center - extents, center + extents); }
+
+    static Aabb Merge(const Aabb& a, const Aabb& b)
+    {
+        return Aabb(
+            Vector3(a.min.x < b.min.x ? a.min.x : b.min.x, a.min.y < b.min.y ? a.min.y : b.min.y, a.min.z < b.min.z ? a.min.z : b.min.z),
+            Vector3(a.max.x > b.max.x ? a.max.x : b.max.x, a.max.y > b.max.y ? a.max.y : b.max.y, a.max.z > b.max.z ? a.max.z : b.max.z)
+        );
+    }
+
+    Vector3 Center() const { return Vector3((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f); }
+    Vector3 Size() const { return max - min; }
+
+    float SurfaceArea() const
+    {
+        Vector3 d = max - min;
+        return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    Aabb Expanded(const Vector3& amount) const { return Aabb(min - amount, max + amount); }
+
+    bool Overlaps(const Aabb& r) const
+    {
+        return min.x <= r.max.x && max.x >= r.min.x &&
+               min.y <= r.max.y && max.y >= r.min.y &&
+               min.z <= r.max.z && max.z >= r.min.z;
+    }
+
+    bool Contains(const Aabb& r) const
+    {
+        return min.x <= r.min.x && max.x >= r.max.x &&
+               min.y <= r.min.y && max.y >= r.max.y &&
+               min.z <= r.min.z && max.z >= r.max.z;
+    }
+
+    float DistanceSq(const Vector3& point) const
+    {
+        float d = 0;
+
+        for (int i = 0; i < 3; i++)
+        {
+            float v = point[i] < min[i] ? min[i] - point[i] : point[i] > max[i] ? point[i] - max[i] : 0;
+            d += v * v;
+        }
+
+        return d;
+    }
+
+    // distance along the ray where it enters the box, or a negative
+    // number if it misses. invDirection is 1 / direction per axis
+    float Intersect(const Vector3& origin, const Vector3& invDirection, float maxDistance) const
+    {
+        float enter = 0;
+        float exit = maxDistance;
+
+        for (int i = 0; i < 3; i++)
+        {
+            float t0 = (min[i] - origin[i]) * invDirection[i];
+            float t1 = (max[i] - origin[i]) * invDirection[i];
+
+            if (t0 > t1) std::swap(t0, t1);
+
+            enter = t0 > enter ? t0 : enter;
+            exit = t1 < exit ? t1 : exit;
+
+            if (enter > exit) return -1;
+        }
+
+        return enter;
+    }
+};
+
+// Six planes facing inwards, stored as (normal, distance) in the order
+// left, right, bottom, top, near, far
+struct OASIS_API Frustum
+{
+    static const int COUNT = 6;
+
+    Vector4 planes[COUNT];
+
+    // extracts the planes of a view-projection matrix whose clip space
+    // spans -w to w on every axis
+    static Frustum FromMatrix(const Matrix4& m)
+    {
+        Vector4 row0(m.m00, m.m01, m.m02, m.m03);
+        Vector4 row1(m.m10, m.m11, m.m12, m.m13);
+        Vector4 row2(m.m20, m.m21, m.m22, m.m23);
+        Vector4 row3(m.m30, m.m31, m.m32, m.m33);
+
+        Frustum f;
+        f.planes[0] = row3 + row0;
+        f.planes[1] = row3 - row0;
+        f.planes[2] = row3 + row1;
+        f.planes[3] = row3 - row1;
+        f.planes[4] = row3 + row2;
+        f.planes[5] = row3 - row2;
+        return f;
+    }
+
+    // conservative, may report boxes just outside a corner
+    bool Overlaps(const Aabb& box) const
+    {
+        for (int i = 0; i < COUNT; i++)
+        {
+            const Vector4& p = planes[i];
+
+            // corner furthest along the plane normal
+            float x = p.x >= 0 ? box.max.x : box.min.x;
+            float y = p.y >= 0 ? box.max.y : box.min.y;
+            float z = p.z >= 0 ? box.max.z : box.min.z;
+
+            if (p.x * x + p.y * y + p.z * z + p.w < 0) return false;
+        }
+
+        return true;
+    }
+};
+
+}
@@ -8,3 +8,4 @@
 #include "Oasis/Math/Quaternion.h"
 #include "Oasis/Math/Matrix3.h"
 #include "Oasis/Math/Matrix4.h"
+#include "Oasis/Math/Bounds.h"
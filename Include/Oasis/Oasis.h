@@ -6,7 +6,13 @@
 #include "Oasis/Core/Config.h" 
 #include "Oasis/Core/Display.h" 
 #include "Oasis/Core/Engine.h"
+#include "Oasis/Core/EventManager.h" 
+#include "Oasis/Core/FrameArena.h" 
+#include "Oasis/Core/FramePacer.h" 
+#include "Oasis/Core/MemoryTracker.h" 
+#include "Oasis/Core/Profiler.h" 
 #include "Oasis/Core/ReferenceCounted.h" 
+#include "Oasis/Core/Telemetry.h" 
 #include "Oasis/Core/Timer.h" 
 #include "Oasis/Core/TimeUtil.h" 
 
@@ -16,6 +22,7 @@
 #include "Oasis/Graphics/IndexBuffer.h" 
 #include "Oasis/Graphics/Mesh.h" 
 #include "Oasis/Graphics/Renderer.h" 
+#include "Oasis/Graphics/RenderState.h" 
 #include "Oasis/Graphics/RenderTexture2D.h" 
 #include "Oasis/Graphics/Shader.h" 
 #include "Oasis/Graphics/Texture.h" 
@@ -27,8 +34,10 @@
 
 #include "Oasis/Scene/Component.h" 
 #include "Oasis/Scene/Entity.h" 
+#include "Oasis/Scene/Hierarchy.h" 
 #include "Oasis/Scene/Scene.h" 
 #include "Oasis/Scene/SceneManager.h" 
+#include "Oasis/Scene/SpatialIndex.h" 
 #include "Oasis/Scene/System.h" 
 
 #include "Oasis/Util/ClassId.h" 
@@ -0,0 +1,181 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+#include "Oasis/Scene/ComponentMask.h" 
+#include "Oasis/Scene/ComponentType.h" 
+#include "Oasis/Scene/EntityId.h" 
+
+namespace Oasis 
+{
+
+// Whether a change version is newer than another. Versions wrap around,
+// so this holds while they are less than 2^31 apart, a component not
+// written for that long shows up as changed once more. 0 is older than
+// every other version.
+inline bool IsNewerVersion(uint32 version, uint32 than) 
+{
+    return than ? static_cast<int32>(version - than) > 0 : version != 0; 
+}
+
+// Stores every entity that has exactly the same set of components.
+// Rows are packed into fixed-size chunks, each chunk holding one
+// array per component (SoA) plus the entity ids. Rows are kept
+// dense: removing a row moves the last row into its place.
+//
+// Every component also has a change version per row, the entity
+// manager's change version when it was last written, and every chunk
+// keeps the highest change version of each column so unchanged chunks
+// can be skipped without looking at their rows.
+class OASIS_API EntityArchetype 
+{
+public: 
+    static const uint32 CHUNK_SIZE; 
+
+    // chunks are aligned to this or the largest component alignment
+    static const uint32 CHUNK_ALIGNMENT; 
+
+    // types must be sorted by id, mask has the bit of each type set
+    EntityArchetype(const std::vector<const ComponentType*>& types, const ComponentMask& mask); 
+    ~EntityArchetype(); 
+
+    OASIS_NO_COPY(EntityArchetype) 
+
+    inline uint32 GetEntityCount() const { return count_; } 
+
+    // incremented whenever a row is added or removed
+    inline uint32 GetStructureVersion() const { return structureVersion_; } 
+    inline uint32 GetChunkCapacity() const { return chunkCapacity_; } 
+    inline uint32 GetChunkCount() const { return (count_ + chunkCapacity_ - 1) / chunkCapacity_; } 
+
+    inline uint32 GetChunkEntityCount(uint32 chunk) const 
+    {
+        uint32 start = chunk * chunkCapacity_; 
+        return count_ - start < chunkCapacity_ ? count_ - start : chunkCapacity_; 
+    }
+
+    inline uint32 GetColumnCount() const { return columns_.size(); } 
+    inline const ComponentType& GetColumnType(uint32 column) const { return *columns_[column].type; } 
+    inline const std::vector<ClassId>& GetTypeIds() const { return typeIds_; } 
+    inline const ComponentMask& GetMask() const { return mask_; } 
+
+    inline int GetColumnIndex(ClassId id) const 
+    {
+        return id < columnIndices_.size() ? columnIndices_[id] : -1; 
+    }
+
+    inline bool Has(ClassId id) const { return GetColumnIndex(id) != -1; } 
+
+    inline const EntityId* GetChunkEntities(uint32 chunk) const 
+    {
+        return (const EntityId*) chunks_[chunk]; 
+    }
+
+    inline void* GetChunkColumn(uint32 chunk, uint32 column) const 
+    {
+        return chunks_[chunk] + columns_[column].offset; 
+    }
+
+    inline const EntityId& GetEntityId(uint32 row) const 
+    {
+        return GetChunkEntities(row / chunkCapacity_)[row % chunkCapacity_]; 
+    }
+
+    // address of the column element, for POOL columns this is the pool slot
+    inline void* GetElement(uint32 row, uint32 column) const 
+    {
+        const Column& c = columns_[column]; 
+        return chunks_[row / chunkCapacity_] + c.offset + (row % chunkCapacity_) * c.size; 
+    }
+
+    // allocates chunks up front so count more rows can be added
+    void Reserve(uint32 count); 
+
+    inline uint32* GetChunkChangeVersions(uint32 chunk, uint32 column) const 
+    {
+        return (uint32*) (chunks_[chunk] + columns_[column].changeOffset); 
+    }
+
+    inline uint32 GetChunkChangeVersion(uint32 chunk, uint32 column) const 
+    {
+        return chunkChangeVersions_[chunk * columns_.size() + column]; 
+    }
+
+    // for query columns, which raise it when a row is written
+    inline uint32* GetChunkChangeVersionAddress(uint32 chunk, uint32 column) 
+    {
+        return &chunkChangeVersions_[chunk * columns_.size() + column]; 
+    }
+
+    inline uint32 GetChangeVersion(uint32 row, uint32 column) const 
+    {
+        return GetChunkChangeVersions(row / chunkCapacity_, column)[row % chunkCapacity_]; 
+    }
+
+    inline void SetChangeVersion(uint32 row, uint32 column, uint32 version) 
+    {
+        GetChunkChangeVersions(row / chunkCapacity_, column)[row % chunkCapacity_] = version; 
+        MarkChunkChanged(row / chunkCapacity_, column, version); 
+    }
+
+    // raises the chunk's change version of the column, rows are not touched
+    inline void MarkChunkChanged(uint32 chunk, uint32 column, uint32 version) 
+    {
+        uint32& v = chunkChangeVersions_[chunk * columns_.size() + column]; 
+        if (IsNewerVersion(version, v)) v = version; 
+    }
+
+    // adds a row with uninitialized components and returns its index
+    uint32 AddRow(const EntityId& id); 
+
+    // removes a row whose components have already been destroyed or
+    // moved out, returns true if another row was moved into its place
+    bool RemoveRow(uint32 row, EntityId& moved); 
+
+    EntityArchetype* GetAddEdge(ClassId id) const; 
+    EntityArchetype* GetRemoveEdge(ClassId id) const; 
+
+    void SetAddEdge(ClassId id, EntityArchetype* archetype); 
+    void SetRemoveEdge(ClassId id, EntityArchetype* archetype); 
+
+private: 
+    struct Column 
+    {
+        const ComponentType* type; 
+        uint32 offset; 
+        uint32 changeOffset; 
+        uint32 size; 
+        uint32 alignment; 
+    };
+
+    void MoveElement(uint32 column, void* dest, void* src); 
+    void AllocateChunk(); 
+
+    // bytes malloc'd for a chunk, with room to align it
+    inline uint32 GetAllocationBytes() const { return chunkBytes_ + chunkAlignment_; } 
+
+    // frees every chunk past the first spare one
+    void TrimChunks(); 
+
+    std::vector<Column> columns_; 
+    std::vector<ClassId> typeIds_; 
+
+    // column of each component ClassId, -1 if not stored here
+    std::vector<int32> columnIndices_; 
+    ComponentMask mask_; 
+    std::vector<uint8*> chunks_; 
+    std::vector<void*> allocations_; 
+
+    // chunk * column count + column
+    std::vector<uint32> chunkChangeVersions_; 
+
+    // indexed by component ClassId, null until first used
+    std::vector<EntityArchetype*> addEdges_; 
+    std::vector<EntityArchetype*> removeEdges_; 
+    uint32 chunkCapacity_ = 1; 
+    uint32 chunkBytes_ = 0; 
+    uint32 chunkAlignment_ = CHUNK_ALIGNMENT; 
+    uint32 count_ = 0; 
+    uint32 structureVersion_ = 0; 
+};
+
+}
@@ -0,0 +1,108 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+#include "Oasis/Scene/ComponentType.h" 
+#include "Oasis/Scene/EntityId.h" 
+
+namespace Oasis 
+{
+
+class EntityManager; 
+
+// Records structural changes (create, destroy, attach, detach) to be
+// applied to an entity manager later, at a point where no system is
+// iterating its storage. A buffer must only be recorded to from one
+// thread at a time, and must not outlive its manager.
+class OASIS_API EntityCommandBuffer 
+{
+public: 
+    explicit EntityCommandBuffer(EntityManager& manager); 
+    ~EntityCommandBuffer(); 
+
+    OASIS_NO_COPY(EntityCommandBuffer) 
+
+    inline EntityManager& GetManager() { return manager_; } 
+
+    inline bool IsEmpty() const { return commands_.empty(); } 
+    inline uint32 GetCommandCount() const { return commands_.size(); } 
+
+    // the id is reserved now and can be used by later commands,
+    // but the entity only becomes valid on playback
+    EntityId CreateEntity(); 
+
+    void DestroyEntity(const EntityId& id); 
+
+    // the returned component is the recorded copy, changes made to
+    // it before playback are applied with it
+    Component* AttachComponent(const EntityId& id, const ComponentType& type, const Component* from); 
+
+    void DetachComponent(const EntityId& id, ClassId compId); 
+
+    template <class T, class ... Args> 
+    T* Attach(const EntityId& id, Args... args) 
+    {
+        T from(args...); 
+        return (T*) AttachComponent(id, GetComponentType<T>(), &from); 
+    }
+
+    template <class T> 
+    void Detach(const EntityId& id) 
+    {
+        DetachComponent(id, GetClassId<T>()); 
+    }
+
+    // applies every command in recorded order, then clears the buffer,
+    // fails if the manager is locked
+    bool Playback(); 
+
+    // Plays back buffers of the same manager together, applying their
+    // commands in the order they were recorded across all of them, so
+    // a command may use an entity created through another thread's buffer.
+    static bool Playback(EntityCommandBuffer* const* buffers, uint32 count); 
+
+    // drops every command without applying it
+    void Clear(); 
+
+private: 
+    static const uint32 PAGE_SIZE; 
+
+    enum class CommandType 
+    {
+        CREATE, 
+        DESTROY, 
+        ATTACH, 
+        DETACH, 
+
+        count 
+    };
+
+    struct Command 
+    {
+        CommandType type; 
+        EntityId id; 
+        ClassId componentId; 
+        const ComponentType* componentType; 
+        void* data; 
+
+        // order of recording across the manager's buffers
+        uint64 sequence; 
+    };
+
+    void Record(Command& c); 
+    void Apply(Command& c); 
+
+    void* Allocate(uint32 size, uint32 alignment); 
+    void ReleaseMemory(); 
+
+    EntityManager& manager_; 
+    std::vector<Command> commands_; 
+
+    // component copies, pages are never moved so
+    // returned pointers stay valid until playback
+    std::vector<uint8*> pages_; 
+    std::vector<void*> largeAllocations_; 
+    uint32 page_ = 0; 
+    uint32 pageOffset_ = 0; 
+};
+
+}
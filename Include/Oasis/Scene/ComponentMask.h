@@ -0,0 +1,28 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+
+#include <bitset> 
+
+#ifndef OASIS_MAX_COMPONENT_TYPES 
+    #define OASIS_MAX_COMPONENT_TYPES 256 
+#endif 
+
+namespace Oasis 
+{
+
+// One bit per component type, indexed by the component's ClassId
+using ComponentMask = std::bitset<OASIS_MAX_COMPONENT_TYPES>; 
+
+inline void SetComponentBit(ComponentMask& mask, ClassId compId) 
+{
+    if (compId >= OASIS_MAX_COMPONENT_TYPES) 
+    {
+        Logger::Fatal("ComponentMask: More than ", OASIS_MAX_COMPONENT_TYPES, " component types, increase OASIS_MAX_COMPONENT_TYPES"); 
+        std::abort(); 
+    }
+
+    mask.set(compId); 
+}
+
+}
@@ -1,9 +1,11 @@
 #pragma once 
 
 #include "Oasis/Common.h" 
+#include "Oasis/Core/MemoryTracker.h" 
 #include "Oasis/Util/IdManager.h" 
 
 #include <new> 
+#include <typeinfo> 
 
 namespace Oasis
 {
@@ -17,17 +19,38 @@ public:
 
     virtual Component* GetComponent(uint32 index) = 0; 
 
+    // makes room for slots below count, never shrinks
     virtual void Reserve(uint32 count) = 0; 
 
+    // one past the highest slot in use
+    virtual uint32 GetSize() const = 0; 
+
     virtual uint32 CreateComponent(const Component* from) = 0; 
 
     virtual bool DestroyComponent(uint32 id) = 0; 
 };
 
+// Stores components in fixed-size pages that are never moved or freed
+// while the pool lives, so a component's address stays valid until it
+// is destroyed and growing the pool never copies existing components.
+// Released slots are reused first. Pages are counted in the memory
+// tracker under a tag of the component type, below COMPONENTS.
 template <class T> 
 class OASIS_API ComponentPool : public ComponentPoolBase 
 {
 public: 
+    // target page size in bytes, pages hold a power of two components
+    static const uint32 PAGE_BYTES = 16 * 1024; 
+
+    ComponentPool() 
+        : tag_(MemoryTracker::RegisterTag(GetTypeName(typeid(T)), MemoryTracker::COMPONENTS)) 
+    {
+        while ((2u << pageShift_) * sizeof (T) <= PAGE_BYTES) 
+        {
+            pageShift_++; 
+        }
+    }
+
     ~ComponentPool() 
     {
         uint32 max = ids_.Size(); 
@@ -35,13 +58,29 @@ public:
         {
             DestroyComponent(i); 
         }
+
+        for (auto allocation : allocations_) 
+        {
+            std::free(allocation); 
+            MemoryTracker::Freed(tag_, GetPageBytes()); 
+        }
+    }
+
+    OASIS_NO_COPY(ComponentPool) 
+
+    inline uint32 GetPageCapacity() const { return 1u << pageShift_; } 
+
+    // address of a slot without checking that it is in use
+    inline T* Get(uint32 index) const 
+    {
+        return pages_[index >> pageShift_] + (index & (GetPageCapacity() - 1)); 
     }
 
     Component* GetComponent(uint32 index) override 
     {
         if (ids_.IsValid(index)) 
         {
-            return (Component*) &data_[index * sizeof (T)]; 
+            return (Component*) Get(index); 
         }
         else 
         {
@@ -51,16 +90,23 @@ public:
 
     void Reserve(uint32 count) override 
     {
-        data_.resize(count * sizeof (T)); 
+        while (pages_.size() << pageShift_ < count) 
+        {
+            AllocatePage(); 
+        }
+    }
+
+    uint32 GetSize() const override 
+    {
+        return ids_.Size(); 
     }
 
     uint32 CreateComponent(const Component* from) override 
     {
         uint32 id = ids_.Get(); 
 
-        // TODO create 
-        Reserve(ids_.Size()); 
-        CreateComponentFromAddress(&data_[id * sizeof (T)], from); 
+        Reserve(id + 1); 
+        CreateComponentFromAddress(Get(id), from); 
 
         return id; 
     }
@@ -71,15 +117,35 @@ public:
 
         if (existed) 
         {
-            DestroyComponentFromAddress(&data_[id * sizeof (T)]); 
+            DestroyComponentFromAddress(Get(id)); 
         }
 
         return existed; 
     }
 
 private: 
-    std::vector<uint8> data_; 
+    std::vector<T*> pages_; 
+    std::vector<void*> allocations_; 
+    uint32 pageShift_ = 0; 
     IdManager32 ids_; 
+    uint32 tag_; 
+
+    inline size_t GetPageBytes() const 
+    {
+        return (sizeof (T) << pageShift_) + alignof (T); 
+    }
+
+    void AllocatePage() 
+    {
+        uintptr_t alignment = alignof (T); 
+        void* allocation = std::malloc(GetPageBytes()); 
+        uintptr_t aligned = ((uintptr_t) allocation + alignment - 1) / alignment * alignment; 
+
+        allocations_.push_back(allocation); 
+        pages_.push_back((T*) aligned); 
+
+        MemoryTracker::Allocated(tag_, GetPageBytes()); 
+    }
 
     void CreateComponentFromAddress(void* address, const Component* from)  
     {
@@ -99,4 +165,4 @@ private:
     }
 };
 
-}
\ No newline at end of file
+}
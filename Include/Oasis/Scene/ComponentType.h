@@ -0,0 +1,114 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+#include "Oasis/Scene/Component.h" 
+#include "Oasis/Scene/ComponentPool.h" 
+
+#include <new> 
+#include <type_traits> 
+#include <utility> 
+
+// Selects the storage used for a component type. Must be used in the
+// global namespace, e.g. OASIS_COMPONENT_STORAGE(Health, POOL)
+#define OASIS_COMPONENT_STORAGE(Type, Storage) \
+    namespace Oasis { \
+        template <> struct ComponentStorageOf<Type> \
+        { \
+            static const ComponentStorage value = ComponentStorage::Storage; \
+        }; \
+    }
+
+namespace Oasis 
+{
+
+enum class ComponentStorage 
+{
+    // packed per archetype in fixed-size chunks,
+    // fastest to iterate but moves when the entity's
+    // component set changes
+    ARCHETYPE = 0, 
+
+    // stored in a separate ComponentPool, the archetype
+    // only keeps the pool slot
+    POOL = 1, 
+
+    count 
+};
+
+template <class T> 
+struct ComponentStorageOf 
+{
+    static const ComponentStorage value = ComponentStorage::ARCHETYPE; 
+};
+
+struct OASIS_API ComponentType 
+{
+    ClassId id; 
+    uint32 size; 
+    uint32 alignment; 
+    ComponentStorage storage; 
+
+    // construct at dest, copying src (or default if src is null)
+    void (*copy)(void* dest, const void* src); 
+
+    // construct at dest from src, then destroy src
+    void (*move)(void* dest, void* src); 
+
+    void (*destroy)(void* address); 
+
+    ComponentPoolBase* (*createPool)(); 
+};
+
+template <class T> 
+struct OASIS_API ComponentTypeFunctions 
+{
+    static void Copy(void* dest, const void* src) 
+    {
+        if (src) 
+        {
+            new(dest) T(*((const T*) src)); 
+        }
+        else 
+        {
+            new(dest) T(); 
+        }
+    }
+
+    static void Move(void* dest, void* src) 
+    {
+        new(dest) T(std::move(*((T*) src))); 
+        ((T*) src)->~T(); 
+    }
+
+    static void Destroy(void* address) 
+    {
+        ((T*) address)->~T(); 
+    }
+
+    static ComponentPoolBase* CreatePool() 
+    {
+        return new ComponentPool<T>(); 
+    }
+};
+
+template <class T> 
+OASIS_API const ComponentType& GetComponentType() 
+{
+    static_assert(std::is_base_of<Component, T>::value, "Components must derive from Component"); 
+
+    static const ComponentType type = 
+    {
+        GetClassId<T>(), 
+        sizeof (T), 
+        alignof (T), 
+        ComponentStorageOf<T>::value, 
+        &ComponentTypeFunctions<T>::Copy, 
+        &ComponentTypeFunctions<T>::Move, 
+        &ComponentTypeFunctions<T>::Destroy, 
+        &ComponentTypeFunctions<T>::CreatePool 
+    };
+
+    return type; 
+}
+
+}
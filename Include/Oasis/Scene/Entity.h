@@ -28,12 +28,20 @@ public:
         return manager_->HasComponent<T>(id_); 
     }
 
+    // see EntityManager::GetComponent for how long the pointer is valid
     template <class T> 
     T* Get() 
     {
         return manager_->GetComponent<T>(id_); 
     }
 
+    // same as Get, but marks the component changed
+    template <class T> 
+    T* GetMutable() 
+    {
+        return manager_->GetMutableComponent<T>(id_); 
+    }
+
     template <class T, class ... Args> 
     T* Attach(Args... args) 
     {
@@ -1,10 +1,17 @@
 #pragma once 
 
 #include "Oasis/Common.h" 
+#include "Oasis/Scene/Archetype.h" 
+#include "Oasis/Scene/CommandBuffer.h" 
 #include "Oasis/Scene/ComponentPool.h" 
+#include "Oasis/Scene/ComponentType.h" 
 #include "Oasis/Scene/EntityId.h" 
 #include "Oasis/Scene/FilterCache.h" 
 
+#include <atomic> 
+#include <mutex> 
+#include <thread> 
+
 namespace Oasis 
 {
 
@@ -16,31 +23,84 @@ public:
 
     inline EntityFilterCache& GetFilterCache() { return filterCache_; } 
 
+    // While locked, structural changes (create, destroy, attach, detach)
+    // are recorded into the calling thread's command buffer instead of
+    // being applied, so storage being iterated does not move. The buffers
+    // are played back when the last lock is released. Systems updated
+    // in parallel lock from several threads while their batch holds an
+    // outer lock, so only the batch's unlock plays back.
+    void Lock(); 
+    void Unlock(); 
+    inline bool IsLocked() const { return lockCount_ > 0; } 
+
+    // Command buffer for the calling thread, played back on unlock. The
+    // buffers of all threads are played back together, in the order
+    // their commands were recorded.
+    EntityCommandBuffer& GetCommandBuffer(); 
+
+    // reserves an id for an entity created later by a command buffer,
+    // safe to call from any thread while locked
+    EntityId ReserveEntityId(); 
+
     EntityId CreateEntityId(); 
+
+    // false if the entity is not valid, counted like DestroyEntities
     bool DestroyEntityId(const EntityId&); 
 
+    // Creates count entities that have the given components, copied
+    // from prototypes (one per type, null or missing default constructs).
+    // Storage is allocated and filters are updated once for the whole
+    // batch. Ids are written to out if it is not null.
+    void CreateEntities(uint32 count, const std::vector<const ComponentType*>& types, const std::vector<const Component*>& prototypes, EntityId* out = nullptr); 
+
+    // creates count copies of every component of the prototype entity,
+    // false if the prototype is not valid
+    bool CreateEntities(uint32 count, const EntityId& prototype, EntityId* out = nullptr); 
+
+    // Destroys every valid entity in the list, returns how many. While
+    // locked the destroys are recorded and the entities valid at that
+    // time are counted, not those created by commands not played yet.
+    uint32 DestroyEntities(const EntityId* ids, uint32 count); 
+
+    template <class... Components> 
+    void CreateEntities(uint32 count, EntityId* out = nullptr) 
+    {
+        CreateEntities(count, { &GetComponentType<Components>()... }, {}, out); 
+    }
+
     bool IsValidEntityId(const EntityId& id) const; 
 
+    inline uint32 GetEntityCount() const { return ids_.Count(); } 
+
     bool HasComponent(const EntityId& id, ClassId compId) const; 
 
+    // archetype the entity is currently stored in, or null if invalid
+    EntityArchetype* GetArchetype(const EntityId& id) const; 
+
+    inline const std::vector<EntityArchetype*>& GetArchetypes() const { return archetypes_; } 
+
     template <class T> 
     bool HasComponent(const EntityId& id) 
     {
         return HasComponent(id, GetClassId<T>()); 
     }
 
+    // Only components stored with OASIS_COMPONENT_STORAGE(T, POOL) keep
+    // their address until they are detached. The default ARCHETYPE
+    // storage moves components whenever the entity gains or loses a
+    // component, or another entity of its archetype is destroyed, so
+    // do not keep those pointers across structural changes.
     template <class T> 
     T* GetComponent(const EntityId& id) 
     {
-        CheckComponentPool<T>(); 
         return (T*) GetComponent(id, GetClassId<T>()); 
     }
 
     template <class T, class ... Args> 
     T* AttachComponent(const EntityId& id, Args... args) 
     {
-        CheckComponentPool<T>(); 
-        return (T*) AttachComponent(id, GetClassId<T>(), T(args...)); 
+        T from(args...); 
+        return (T*) AttachComponent(id, GetComponentType<T>(), &from); 
     }
 
     template <class T> 
@@ -49,51 +109,143 @@ public:
         return DetachComponent(id, GetClassId<T>()); 
     }
 
+    // Change version written to components when they are created.
+    // Versions wrap around, compare them with IsNewerVersion.
+    inline uint32 GetChangeVersion() const { return changeVersion_.load(); } 
+
+    // returns the current change version and advances it, so writes
+    // made after the caller's run have a higher version than the run,
+    // 0 is skipped as it stands for a system that never ran
+    uint32 NextChangeVersion(); 
+
+    // Version written by GetMutableComponent and MarkChanged: the one
+    // of the system run in progress on the calling thread (see
+    // ChangeVersionScope), the current change version outside of runs.
+    // Non-const query columns write their query's version. GetComponent
+    // does not count as a write.
+    uint32 GetWriteVersion() const; 
+
+    // marks the component changed, false if the entity does not have it
+    bool MarkChanged(const EntityId& id, ClassId compId); 
+
+    template <class T> 
+    bool MarkChanged(const EntityId& id) 
+    {
+        return MarkChanged(id, GetClassId<T>()); 
+    }
+
+    // same as GetComponent, but marks the component changed
+    template <class T> 
+    T* GetMutableComponent(const EntityId& id) 
+    {
+        return (T*) GetMutableComponent(id, GetClassId<T>()); 
+    }
+
+    // pool backing a POOL storage component, or null
+    ComponentPoolBase* GetComponentPool(ClassId compId) const; 
+
 private: 
-    using ComponentEntry = std::pair<ClassId, uint32>; 
+    friend class EntityCommandBuffer; 
+    friend class ChangeVersionScope; 
 
     struct EntityEntry 
     {
         bool valid = false; 
         uint32 version = 0; 
-        std::vector<ComponentEntry> components; 
+        EntityArchetype* archetype = nullptr; 
+        uint32 row = 0; 
 
-        void OnCreate() 
+        void OnCreate(uint32 newVersion) 
         {
-            version++; 
+            version = newVersion; 
             valid = true; 
         }
 
         void OnDestroy() 
         {
-            components.clear(); 
+            archetype = nullptr; 
+            row = 0; 
             valid = false; 
         }
     }; 
 
-    template <class T>
-    void CheckComponentPool() 
-    {
-        if (!componentPools_[GetClassId<T>()]) 
-        {
-            componentPools_[GetClassId<T>()] = new ComponentPool<T>(); 
-        }
-    }
-
     bool IdInBounds(uint32 id) const; 
 
-    int FindComponentIndex(uint32 entityId, ClassId compId) const; 
+    // version for the next entity with the id, mutex_ must be held
+    uint32 TakeNextVersion(uint32 id); 
+
+    bool CreateReservedEntityId(const EntityId& id); 
+    void ReleaseReservedEntityId(const EntityId& id); 
+
+    void PlaybackCommandBuffers(); 
+
+    // allocates archetype rows and pool slots for count more entities
+    void ReserveStorage(EntityArchetype* archetype, uint32 count); 
+
+    // prototypes are in the archetype's column order, out may be null
+    void CreateEntitiesIn(uint32 count, EntityArchetype* archetype, const std::vector<const Component*>& prototypes, EntityId* out); 
+
+    EntityEntry* GetValidEntry(const EntityId& id); 
+    const EntityEntry* GetValidEntry(const EntityId& id) const; 
 
     Component* GetComponent(const EntityId& id, ClassId compId); 
+    Component* GetMutableComponent(const EntityId& id, ClassId compId); 
 
-    Component* AttachComponent(const EntityId& id, ClassId compId, const Component& from); 
+    Component* AttachComponent(const EntityId& id, const ComponentType& type, const Component* from); 
 
     bool DetachComponent(const EntityId& id, ClassId compId); 
 
+    Component* GetElementComponent(EntityArchetype* archetype, uint32 row, uint32 column); 
+
+    ComponentPoolBase* GetOrCreatePool(const ComponentType& type); 
+
+    void ConstructElement(EntityArchetype* archetype, uint32 row, uint32 column, const void* from); 
+    void DestroyElement(EntityArchetype* archetype, uint32 row, uint32 column); 
+
+    // moves an entity to another archetype, components not in the
+    // destination are destroyed and new ones are left uninitialized
+    uint32 MoveEntity(EntityEntry& entity, EntityArchetype* dest); 
+    void RemoveRow(EntityArchetype* archetype, uint32 row); 
+
+    EntityArchetype* GetArchetype(const std::vector<const ComponentType*>& types); 
+    EntityArchetype* GetArchetypeWith(EntityArchetype* archetype, const ComponentType& type); 
+    EntityArchetype* GetArchetypeWithout(EntityArchetype* archetype, ClassId compId); 
+
     std::vector<EntityEntry> entities_; 
-    std::unordered_map<ClassId, ComponentPoolBase*> componentPools_; 
+    std::vector<EntityArchetype*> archetypes_; 
+    std::unordered_map<ComponentMask, EntityArchetype*> archetypeLookup_; 
+    EntityArchetype* emptyArchetype_; 
+    // indexed by component ClassId, created on first use
+    std::vector<ComponentPoolBase*> componentPools_; 
     IdManager32 ids_; 
     EntityFilterCache filterCache_; 
+
+    // versions of reserved ids past the end of entities_ that were
+    // released without being created, so they are not reused as-is
+    std::unordered_map<uint32, uint32> releasedVersions_; 
+
+    std::vector<std::pair<std::thread::id, EntityCommandBuffer*>> commandBuffers_; 
+    std::vector<EntityCommandBuffer*> playbackBuffers_; 
+    std::mutex mutex_; 
+    std::atomic<uint32> lockCount_; 
+    std::atomic<uint32> changeVersion_; 
+    std::atomic<uint64> commandSequence_; 
+    uint64 serial_; 
+}; 
+
+// Makes writes through GetMutableComponent and MarkChanged on the
+// calling thread use the version of a system run while it exists, so
+// the run does not see its own writes as changes the next time. Scopes
+// nest, for runs and jobs started on a thread that waits for others.
+class OASIS_API ChangeVersionScope 
+{
+public: 
+    ChangeVersionScope(const EntityManager& manager, uint32 version); 
+    ~ChangeVersionScope(); 
+
+private: 
+    uint64 previousSerial_; 
+    uint32 previousVersion_; 
 }; 
 
-}
\ No newline at end of file
+}
@@ -1,10 +1,12 @@
 #pragma once 
 
 #include "Oasis/Common.h" 
+#include "Oasis/Scene/Component.h" 
 
 namespace Oasis
 {
 
+class EntityArchetype; 
 struct EntityId; 
 class EntityManager; 
 
@@ -14,6 +16,9 @@ public:
     EntityFilter(const std::vector<ClassId>& include, const std::vector<ClassId>& exclude); 
     EntityFilter() {} 
 
+    inline const std::vector<ClassId>& GetIncludes() const { return include_; } 
+    inline const std::vector<ClassId>& GetExcludes() const { return exclude_; } 
+
     bool Includes(ClassId id) const; 
     bool Excludes(ClassId id) const; 
 
@@ -23,18 +28,19 @@ public:
     template <class T>
     EntityFilter& Include() 
     {
+        static_assert(std::is_base_of<Component, T>::value, "Components must derive from Component"); 
         return Include(GetClassId<T>()); 
     }
 
     template <class T> 
     EntityFilter& Exclude() 
     {
+        static_assert(std::is_base_of<Component, T>::value, "Components must derive from Component"); 
         return Exclude(GetClassId<T>()); 
     }
 
+    bool Matches(const EntityArchetype& archetype) const; 
     bool Matches(const EntityManager& manager, const EntityId& id) const; 
-    bool MatchesWith(const EntityManager& manager, const EntityId& id, ClassId compId) const; 
-    bool MatchesWithout(const EntityManager& manager, const EntityId& id, ClassId compId) const; 
 
 private: 
     std::vector<ClassId> include_; 
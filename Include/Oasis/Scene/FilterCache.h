@@ -1,6 +1,7 @@
 #pragma once 
 
 #include "Oasis/Common.h" 
+#include "Oasis/Scene/ComponentMask.h" 
 #include "Oasis/Scene/EntityId.h" 
 #include "Oasis/Scene/Filter.h" 
 #include "Oasis/Util/IdManager.h" 
@@ -8,70 +9,112 @@
 namespace Oasis 
 {
 
+class EntityArchetype; 
 class EntityManager; 
 
+// Keeps the entities and archetypes matching each registered filter.
+// Equivalent filters share one entry, counted by references, and each
+// entry is placed under a broader one it is a subset of, so a change
+// only tests the filters under those that matched it.
 class OASIS_API EntityFilterCache 
 {
 public: 
     EntityFilterCache(EntityManager* manager); 
 
+    // returns the id of an equivalent filter if there is one, each call
+    // needs a matching ReleaseFilterId
     uint32 GetFilterId(const EntityFilter& filter); 
 
+    // true if this was the last reference to the filter
     bool ReleaseFilterId(uint32 id); 
 
-    void GetEntities(uint32 filterId, uint32& count, const EntityId*& entities) const; 
+    // number of distinct filters
+    inline uint32 GetFilterCount() const { return ids_.Count(); } 
 
-    void Lock(); 
+    void GetEntities(uint32 filterId, uint32& count, const EntityId*& entities) const; 
 
-    void Unlock(); 
+    // archetypes matching the filter, only grows while the filter is alive
+    const std::vector<EntityArchetype*>& GetArchetypes(uint32 filterId) const; 
 
 private: 
     friend class EntityManager; 
 
+    static const uint32 NOT_FOUND; 
+
     struct Entry 
     {
         int count = 1; 
         EntityFilter filter; 
+        ComponentMask include; 
+        ComponentMask exclude; 
+
+        // sparse set: entities is dense, sparse maps an entity
+        // index to its position in entities
         std::vector<EntityId> entities; 
+        std::vector<uint32> sparse; 
+
+        std::vector<EntityArchetype*> archetypes; 
+
+        // broader entry this one is a subset of, every entity here is
+        // also in the parent
+        uint32 parent = NOT_FOUND; 
+        std::vector<uint32> children; 
+
+        // number of components in include and exclude
+        uint32 constraints = 0; 
 
         Entry(const EntityFilter& filter) : filter(filter) {} 
-    };
 
-    enum class EntityEventType 
-    {
-        CREATE, 
-        DESTROY, 
-        ADD_COMPONENT, 
-        REMOVE_COMPONENT, 
-        count
+        inline bool Matches(const ComponentMask& mask) const 
+        {
+            return (mask & include) == include && (mask & exclude).none(); 
+        }
+
+        // true if every entity matching this matches other too
+        inline bool IsSubsetOf(const Entry& other) const 
+        {
+            return (include & other.include) == other.include && (exclude & other.exclude) == other.exclude; 
+        }
+
+        inline bool SameAs(const Entry& other) const 
+        {
+            return include == other.include && exclude == other.exclude; 
+        }
+
+        bool Contains(const EntityId& id) const; 
+        void Insert(const EntityId& id); 
+        bool Erase(const EntityId& id); 
     };
 
-    struct EntityEvent 
+    // calls fn(entry) on the entries from ids down, children of an entry
+    // are only visited if fn returns true for it
+    template <class Fn> 
+    void Visit(const std::vector<uint32>& ids, Fn&& fn) 
     {
-        EntityEvent() {} 
-        EntityEvent(EntityId id, EntityEventType type) : id(id), eventType(type) {} 
-        EntityEvent(EntityId id, EntityEventType type, ClassId compId) : id(id), eventType(type), componentId(compId) {} 
+        for (auto id : ids) 
+        {
+            if (fn(entries_[id])) Visit(entries_[id].children, fn); 
+        }
+    }
 
-        EntityId id; 
-        EntityEventType eventType; 
-        ClassId componentId; 
-    };
+    void Link(uint32 id, uint32 parent); 
+    void Unlink(uint32 id); 
+
+    void OnCreateArchetype(EntityArchetype* archetype); 
 
-    void OnCreateEntity(const EntityId& id); 
-    void OnAddEntityComponent(const EntityId& id, ClassId compId); 
-    void OnRemoveEntityComponent(const EntityId& id, ClassId compId); 
+    void OnCreateEntity(const EntityId& id, const EntityArchetype* archetype); 
+    void OnChangeEntityArchetype(const EntityId& id, const EntityArchetype* from, const EntityArchetype* to); 
     void OnDestroyEntity(const EntityId& id); 
 
-    void OnCreateEntityNoLock(const EntityId& id); 
-    void OnAddEntityComponentNoLock(const EntityId& id, ClassId compId); 
-    void OnRemoveEntityComponentNoLock(const EntityId& id, ClassId compId); 
-    void OnDestroyEntityNoLock(const EntityId& id); 
+    // batched versions, each filter is visited once per batch
+    void OnCreateEntities(const EntityId* ids, uint32 count, const EntityArchetype* archetype); 
+    void OnDestroyEntities(const EntityId* ids, uint32 count); 
 
-    std::vector<EntityEvent> eventBuffer_; 
     std::vector<Entry> entries_; 
+    std::vector<uint32> roots_; 
+    std::vector<EntityArchetype*> noArchetypes_; 
     IdManager32 ids_; 
     EntityManager* entityManager_; 
-    bool lock_ = false; 
 };
 
 }
\ No newline at end of file
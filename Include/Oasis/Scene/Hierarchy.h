@@ -0,0 +1,91 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+#include "Oasis/Math/MathUtil.h" 
+#include "Oasis/Scene/Component.h" 
+#include "Oasis/Scene/System.h" 
+
+namespace Oasis 
+{
+
+// Position, rotation and scale relative to the entity's Parent, or
+// to the world if it has none.
+struct OASIS_API LocalTransform : public Component 
+{
+    Vector3 position = Vector3::ZERO; 
+    Quaternion rotation = Quaternion::AxisAngle(Vector3::UP, 0); 
+    Vector3 scale = Vector3(1); 
+
+    Matrix4 CreateMatrix() const 
+    {
+        return Matrix4::Translation(position) * Matrix4::FromQuaternion(rotation) * Matrix4::Scale(scale); 
+    }
+};
+
+// Makes the entity's LocalTransform relative to another entity. A
+// parent that is not part of the hierarchy is ignored.
+struct OASIS_API Parent : public Component 
+{
+    EntityId entity; 
+};
+
+// World matrix of the entity, cached by the TransformHierarchySystem
+struct OASIS_API WorldTransform : public Component 
+{
+    Matrix4 matrix = Matrix4::IDENTITY; 
+};
+
+// Keeps the WorldTransform of every entity with a LocalTransform and a
+// WorldTransform up to date. The hierarchy is stored as arrays sorted
+// by depth, so parents always come before their children and a single
+// pass in order computes every world matrix, one depth level at a time
+// split across the job system. Only nodes whose local transform or an
+// ancestor's changed are recomputed. The order is rebuilt when entities
+// join or leave the hierarchy or a Parent is changed.
+class OASIS_API TransformHierarchySystem : public EntitySystem 
+{
+public: 
+    // after systems with the default priority, so their writes are seen
+    static const int PRIORITY; 
+
+    TransformHierarchySystem(); 
+
+    // world matrix from the last update, null if not in the hierarchy
+    const Matrix4* GetWorldMatrix(const EntityId& id) const; 
+
+    inline uint32 GetNodeCount() const { return entities_.size(); } 
+    inline uint32 GetDepthCount() const { return levels_.empty() ? 0 : levels_.size() - 1; } 
+
+protected: 
+    void OnUpdate(Scene& scene, uint32 count, const EntityId* entities, float dt) override; 
+
+private: 
+    // index of the entity in the sorted arrays, or -1
+    int32 GetIndex(const EntityId& id) const; 
+
+    bool NeedsRebuild(); 
+    void Rebuild(); 
+
+    // copies changed local transforms, true if any changed
+    bool UpdateLocals(); 
+    void UpdateWorlds(); 
+    void WriteWorlds(); 
+
+    // sorted by depth, parents_ index the same arrays and are -1 for roots
+    std::vector<EntityId> entities_; 
+    std::vector<int32> parents_; 
+    std::vector<Matrix4> locals_; 
+    std::vector<Matrix4> worlds_; 
+    std::vector<uint8> dirty_; 
+
+    // first index of each depth, followed by the node count
+    std::vector<uint32> levels_; 
+
+    // sorted index by entity id, -1 if not in the hierarchy
+    std::vector<int32> indices_; 
+
+    std::vector<ClassId> localChanged_; 
+    std::vector<ClassId> parentChanged_; 
+};
+
+}
@@ -0,0 +1,349 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+#include "Oasis/Core/JobSystem.h" 
+#include "Oasis/Scene/Archetype.h" 
+#include "Oasis/Scene/ComponentPool.h" 
+#include "Oasis/Scene/EntityManager.h" 
+
+#include <type_traits> 
+
+namespace Oasis 
+{
+
+// One component array of a chunk. Archetype components are indexed
+// directly, pool components go through the slot stored in the chunk.
+// Indexing a non-const column marks the row and its chunk changed, so
+// read-only access should ask for const components, and rows that are
+// not written should not be indexed.
+template <class T> 
+struct OASIS_API ComponentColumn 
+{
+    using Type = typename std::remove_const<T>::type; 
+
+    T* data = nullptr; 
+    const uint32* slots = nullptr; 
+    ComponentPool<Type>* pool = nullptr; 
+
+    // row change versions of the chunk and the chunk's own, only set
+    // for non-const columns
+    uint32* changeVersions = nullptr; 
+    uint32* chunkChangeVersion = nullptr; 
+    uint32 changeVersion = 0; 
+
+    inline T& operator[](uint32 index) const 
+    {
+        if (!std::is_const<T>::value) 
+        {
+            changeVersions[index] = changeVersion; 
+            if (*chunkChangeVersion != changeVersion) MarkChunk(); 
+        }
+
+        if (data) return data[index]; 
+
+        return *pool->Get(slots[index]); 
+    }
+
+    // kept out of operator[], which is only one compare for every
+    // row written after the first
+    void MarkChunk() const 
+    {
+        if (IsNewerVersion(changeVersion, *chunkChangeVersion)) *chunkChangeVersion = changeVersion; 
+    }
+};
+
+// Iterates every entity in a set of archetypes that has all of the
+// requested components. Column addresses are resolved once per chunk,
+// so the per-entity cost is only the callback.
+//
+// Structural changes must not be applied to the iterated archetypes
+// while iterating. Inside a system the entity manager is locked, so
+// they are recorded to a command buffer and applied afterwards.
+//
+// A query can also be limited to entities where one of a list of
+// components changed after a given change version. Whole chunks with
+// no such change are skipped before their rows are looked at.
+template <class... Components> 
+class OASIS_API EntityQuery 
+{
+public: 
+    EntityQuery(EntityManager& manager, const std::vector<EntityArchetype*>& archetypes) 
+        : manager_(manager), archetypes_(archetypes), 
+          changeVersion_(manager.GetChangeVersion()), changedSince_(0), changed_(nullptr) {} 
+
+    // writes through the query are marked with changeVersion, and if
+    // changed is not null only entities where one of those components
+    // changed after changedSince are visited
+    EntityQuery(EntityManager& manager, const std::vector<EntityArchetype*>& archetypes, uint32 changeVersion, uint32 changedSince, const std::vector<ClassId>* changed) 
+        : manager_(manager), archetypes_(archetypes), 
+          changeVersion_(changeVersion), changedSince_(changedSince), changed_(changed) {} 
+
+    // fn(Components&...)
+    template <class Fn> 
+    void ForEach(Fn fn) const 
+    {
+        ChunkChanges changes; 
+
+        VisitChunks([&](EntityArchetype* archetype, uint32 chunk) 
+        {
+            GetChunkChanges(archetype, chunk, changes); 
+            CallChunk(archetype, chunk, [&](uint32 count, const EntityId* entities, ComponentColumn<Components>... columns) 
+            {
+                (void) entities; 
+                ForEachRow(count, changes, [&](uint32 i) { fn(columns[i]...); }); 
+            }); 
+        }); 
+    }
+
+    // fn(const EntityId&, Components&...)
+    template <class Fn> 
+    void ForEachEntity(Fn fn) const 
+    {
+        ChunkChanges changes; 
+
+        VisitChunks([&](EntityArchetype* archetype, uint32 chunk) 
+        {
+            GetChunkChanges(archetype, chunk, changes); 
+            CallChunk(archetype, chunk, [&](uint32 count, const EntityId* entities, ComponentColumn<Components>... columns) 
+            {
+                ForEachRow(count, changes, [&](uint32 i) { fn(entities[i], columns[i]...); }); 
+            }); 
+        }); 
+    }
+
+    // fn(uint32 count, const EntityId* entities, ComponentColumn<Components>...)
+    // Chunks without changes are skipped, but the rows of a chunk
+    // that is visited are not filtered.
+    template <class Fn> 
+    void ForEachChunk(Fn fn) const 
+    {
+        VisitChunks([&](EntityArchetype* archetype, uint32 chunk) 
+        {
+            CallChunk(archetype, chunk, fn); 
+        }); 
+    }
+
+    // Same as ForEach and ForEachChunk, but chunks are split across the
+    // job system's threads. fn must be safe to call concurrently for
+    // different entities. Runs on the calling thread if jobs is null.
+    template <class Fn> 
+    void ParallelForEach(JobSystem* jobs, Fn fn) const 
+    {
+        if (!jobs || !jobs->GetWorkerCount()) 
+        {
+            ForEach(fn); 
+            return; 
+        }
+
+        ParallelForEachChunkRef(jobs, [&](EntityArchetype* archetype, uint32 chunk, ChunkChanges& changes) 
+        {
+            GetChunkChanges(archetype, chunk, changes); 
+            CallChunk(archetype, chunk, [&](uint32 count, const EntityId* entities, ComponentColumn<Components>... columns) 
+            {
+                (void) entities; 
+                ForEachRow(count, changes, [&](uint32 i) { fn(columns[i]...); }); 
+            }); 
+        }); 
+    }
+
+    template <class Fn> 
+    void ParallelForEachChunk(JobSystem* jobs, Fn fn) const 
+    {
+        if (!jobs || !jobs->GetWorkerCount()) 
+        {
+            ForEachChunk(fn); 
+            return; 
+        }
+
+        ParallelForEachChunkRef(jobs, [&](EntityArchetype* archetype, uint32 chunk, ChunkChanges& changes) 
+        {
+            (void) changes; 
+            CallChunk(archetype, chunk, fn); 
+        }); 
+    }
+
+    uint32 GetEntityCount() const 
+    {
+        uint32 count = 0; 
+
+        for (auto archetype : archetypes_) 
+        {
+            if (HasAll(archetype)) count += archetype->GetEntityCount(); 
+        }
+
+        return count; 
+    }
+
+private: 
+    // change versions of the filtered columns in one chunk
+    struct ChunkChanges 
+    {
+        bool filtered = false; 
+        uint32 since = 0; 
+        std::vector<const uint32*> versions; 
+
+        inline bool IsChanged(uint32 row) const 
+        {
+            for (auto v : versions) 
+            {
+                if (IsNewerVersion(v[row], since)) return true; 
+            }
+
+            return false; 
+        }
+    };
+
+    // fn(EntityArchetype*, uint32 chunk) for every chunk to visit
+    template <class Fn> 
+    void VisitChunks(Fn fn) const 
+    {
+        for (auto archetype : archetypes_) 
+        {
+            if (!archetype->GetEntityCount() || !HasAll(archetype)) continue; 
+
+            uint32 chunkCount = archetype->GetChunkCount(); 
+
+            for (uint32 chunk = 0; chunk < chunkCount; chunk++) 
+            {
+                if (IsChunkChanged(archetype, chunk)) fn(archetype, chunk); 
+            }
+        }
+    }
+
+    // fn(EntityArchetype*, uint32 chunk, ChunkChanges&) split by chunk across threads
+    template <class Fn> 
+    void ParallelForEachChunkRef(JobSystem* jobs, Fn fn) const 
+    {
+        struct ChunkRef 
+        {
+            EntityArchetype* archetype; 
+            uint32 chunk; 
+        };
+
+        std::vector<ChunkRef> chunks; 
+
+        VisitChunks([&](EntityArchetype* archetype, uint32 chunk) 
+        {
+            chunks.push_back({ archetype, chunk }); 
+        }); 
+
+        // a chunk is already a cache friendly block of work
+        jobs->ParallelFor(chunks.size(), [&](uint32 begin, uint32 end) 
+        {
+            ChangeVersionScope scope(manager_, changeVersion_); 
+            ChunkChanges changes; 
+
+            for (uint32 i = begin; i < end; i++) 
+            {
+                fn(chunks[i].archetype, chunks[i].chunk, changes); 
+            }
+        }, 1); 
+    }
+
+    template <class Fn> 
+    void CallChunk(EntityArchetype* archetype, uint32 chunk, Fn&& fn) const 
+    {
+        fn( 
+            archetype->GetChunkEntityCount(chunk), 
+            archetype->GetChunkEntities(chunk), 
+            GetColumn<Components>(archetype, chunk)... 
+        ); 
+    }
+
+    // fn(uint32 row) for every row of the chunk that passes the change filter
+    template <class Fn> 
+    static void ForEachRow(uint32 count, const ChunkChanges& changes, Fn fn) 
+    {
+        if (!changes.filtered) 
+        {
+            for (uint32 i = 0; i < count; i++) fn(i); 
+        }
+        else 
+        {
+            for (uint32 i = 0; i < count; i++) 
+            {
+                if (changes.IsChanged(i)) fn(i); 
+            }
+        }
+    }
+
+    bool IsChunkChanged(const EntityArchetype* archetype, uint32 chunk) const 
+    {
+        if (!changed_) return true; 
+
+        for (ClassId id : *changed_) 
+        {
+            int32 index = archetype->GetColumnIndex(id); 
+
+            if (index != -1 && IsNewerVersion(archetype->GetChunkChangeVersion(chunk, index), changedSince_)) return true; 
+        }
+
+        return false; 
+    }
+
+    void GetChunkChanges(const EntityArchetype* archetype, uint32 chunk, ChunkChanges& changes) const 
+    {
+        changes.filtered = changed_ != nullptr; 
+        changes.since = changedSince_; 
+        changes.versions.clear(); 
+
+        if (!changed_) return; 
+
+        for (ClassId id : *changed_) 
+        {
+            int32 index = archetype->GetColumnIndex(id); 
+
+            if (index != -1) changes.versions.push_back(archetype->GetChunkChangeVersions(chunk, index)); 
+        }
+    }
+
+    static bool HasAll(const EntityArchetype* archetype) 
+    {
+        bool has[] = { true, archetype->Has(GetClassId<typename std::remove_const<Components>::type>())... }; 
+
+        for (bool h : has) 
+        {
+            if (!h) return false; 
+        }
+
+        return true; 
+    }
+
+    template <class T> 
+    ComponentColumn<T> GetColumn(EntityArchetype* archetype, uint32 chunk) const 
+    {
+        using Type = typename std::remove_const<T>::type; 
+
+        ComponentColumn<T> column; 
+        uint32 index = archetype->GetColumnIndex(GetClassId<Type>()); 
+        void* data = archetype->GetChunkColumn(chunk, index); 
+
+        if (archetype->GetColumnType(index).storage == ComponentStorage::POOL) 
+        {
+            column.slots = (const uint32*) data; 
+            column.pool = (ComponentPool<Type>*) manager_.GetComponentPool(GetClassId<Type>()); 
+        }
+        else 
+        {
+            column.data = (T*) data; 
+        }
+
+        if (!std::is_const<T>::value) 
+        {
+            column.changeVersions = archetype->GetChunkChangeVersions(chunk, index); 
+            column.chunkChangeVersion = archetype->GetChunkChangeVersionAddress(chunk, index); 
+            column.changeVersion = changeVersion_; 
+        }
+
+        return column; 
+    }
+
+    EntityManager& manager_; 
+    const std::vector<EntityArchetype*>& archetypes_; 
+
+    uint32 changeVersion_; 
+    uint32 changedSince_; 
+    const std::vector<ClassId>* changed_; 
+};
+
+}
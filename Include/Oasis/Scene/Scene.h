@@ -10,6 +10,7 @@ namespace Oasis
 {
 
 class EntitySystem; 
+class RenderState; 
 class SceneManager; 
 
 class OASIS_API Scene 
@@ -29,18 +30,79 @@ public:
     Entity GetEntity(const EntityId& id); 
     bool DestroyEntity(const Entity& entity); 
 
+    // creates count copies of the prototype's components at once
+    std::vector<Entity> CreateEntities(uint32 count, const Entity& prototype); 
+
+    // creates count entities with default constructed components at once
+    template <class... Components> 
+    std::vector<Entity> CreateEntities(uint32 count) 
+    {
+        std::vector<EntityId> ids(count); 
+        if (count) entityManager_.CreateEntities<Components...>(count, &ids[0]); 
+
+        return ToEntities(ids); 
+    }
+
+    uint32 DestroyEntities(const std::vector<Entity>& entities); 
+
     void AddSystem(EntitySystem* system, bool autoDelete = true); 
     bool RemoveSystem(EntitySystem* system);    
 
     void Update(float dt); 
     void Render(); 
 
+    // replaces the state with one extracted from the scene's systems
+    void Extract(RenderState& state); 
+
+    // draws a state extracted from this scene, may run while the scene
+    // updates if the scene manager defers deletes
+    void Draw(const RenderState& state); 
+
+    // Scenes marked simulated are updated by SceneManager::Simulate, at
+    // the same time as the other simulated scenes. A scene shares no
+    // state with other scenes, so its systems must only use their own.
+    // The EventManager is shared, so while simulated they may only use
+    // EventManager::QueueEvent, not SendEvent, Subscribe or Unsubscribe.
+    inline bool IsSimulated() const { return simulated_; } 
+    inline void SetSimulated(bool simulated) { simulated_ = simulated; } 
+
+    // fixed step Simulate updates with, 0 updates once with its dt
+    inline float GetTimeStep() const { return timeStep_; } 
+    inline void SetTimeStep(float step) { timeStep_ = step; } 
+
+    // seconds one Simulate may spend catching up on fixed steps, 0 for
+    // no limit. Steps still due when it runs out are dropped.
+    inline double GetTickBudget() const { return tickBudget_; } 
+    inline void SetTickBudget(double seconds) { tickBudget_ = seconds; } 
+
+    // updates by the elapsed time, in fixed steps if there is a time step
+    void Simulate(float dt); 
+
+    inline uint64 GetTickCount() const { return tickCount_; } 
+    inline uint64 GetDroppedTickCount() const { return droppedTickCount_; } 
+
+    // seconds the last Simulate took
+    inline double GetSimulateSeconds() const { return simulateSeconds_; } 
+
 private: 
+    std::vector<Entity> ToEntities(const std::vector<EntityId>& ids); 
+
     EntityManager entityManager_; 
     EntitySystemManager systemManager_; 
     SceneManager& sceneManager_; 
     std::string sceneName_; 
     int sceneIndex_; 
+
+    bool simulated_ = false; 
+    float timeStep_ = 0; 
+    double tickBudget_ = 0; 
+
+    // simulated time not yet stepped
+    double accumulator_ = 0; 
+
+    uint64 tickCount_ = 0; 
+    uint64 droppedTickCount_ = 0; 
+    double simulateSeconds_ = 0; 
 };
 
 }
\ No newline at end of file
@@ -2,9 +2,13 @@
 
 #include "Oasis/Common.h" 
 
+#include <mutex> 
+
 namespace Oasis 
 {
 
+class EntitySystem; 
+class JobSystem; 
 class Scene; 
 
 class OASIS_API SceneManager 
@@ -28,9 +32,44 @@ public:
 
     bool UnloadScene(Scene* scene); 
 
+    inline uint32 GetSceneCount() const { return scenes_.size(); } 
+
+    // Simulates every scene marked simulated by dt, each as its own job
+    // so independent scenes tick at the same time. Returns once all of
+    // them are done. Their systems may only queue events meanwhile, see
+    // Scene::SetSimulated.
+    void Simulate(float dt); 
+
+    // While deletes are deferred, unloaded scenes and removed systems
+    // that are deleted automatically are kept until DeleteRetired. A
+    // pipelined engine defers them, as the frame being drawn may still
+    // refer to them, and deletes them once the render states swap.
+    inline bool IsDeferringDeletes() const { return deferDeletes_; } 
+    inline void SetDeferDeletes(bool defer) { deferDeletes_ = defer; } 
+
+    // deletes the system now or once deletes are no longer deferred,
+    // safe to call from the jobs of simulated scenes
+    void RetireSystem(EntitySystem* system); 
+
+    void DeleteRetired(); 
+
+    // used by scenes to update systems in parallel, not owned,
+    // scenes update their systems one at a time without it
+    inline JobSystem* GetJobSystem() { return jobSystem_; } 
+    inline void SetJobSystem(JobSystem* jobSystem) { jobSystem_ = jobSystem; } 
+
 private: 
     std::vector<Scene*> scenes_; 
     Scene* active_ = nullptr; 
+    JobSystem* jobSystem_ = nullptr; 
+
+    // scenes being simulated
+    std::vector<Scene*> simulated_; 
+
+    bool deferDeletes_ = false; 
+    std::vector<EntitySystem*> retiredSystems_; 
+    std::vector<Scene*> retiredScenes_; 
+    std::mutex retiredMutex_; 
 };
 
 }
\ No newline at end of file
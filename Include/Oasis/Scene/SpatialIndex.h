@@ -0,0 +1,341 @@
+#pragma once 
+
+#include "Oasis/Common.h" 
+#include "Oasis/Math/MathUtil.h" 
+#include "Oasis/Scene/Component.h" 
+#include "Oasis/Scene/Hierarchy.h" 
+#include "Oasis/Scene/System.h" 
+
+namespace Oasis 
+{
+
+// Dynamic bounding volume tree. Leaves hold boxes enlarged by a margin
+// and by the last movement, so small moves do not change the tree, and
+// the tree is kept balanced with rotations as leaves are inserted and
+// removed. Leaf ids stay valid until the leaf is removed, also across
+// Rebuild. Queries only read the tree and may run on several threads.
+class OASIS_API AabbTree 
+{
+public: 
+    static const uint32 NONE; 
+
+    AabbTree(); 
+
+    // the box is enlarged by the margin, returns the leaf id
+    uint32 Insert(const Aabb& box, uint32 data); 
+    void Remove(uint32 leaf); 
+
+    // moves the leaf if the box left its enlarged box, true if it did
+    bool Move(uint32 leaf, const Aabb& box, const Vector3& displacement); 
+
+    // true if Move would change the tree
+    inline bool NeedsMove(uint32 leaf, const Aabb& box) const { return !nodes_[leaf].box.Contains(box); } 
+
+    // Add and SetBox change leaves without changing the tree, which
+    // has to be rebuilt before it is queried or changed again
+    uint32 Add(const Aabb& box, uint32 data); 
+    void SetBox(uint32 leaf, const Aabb& box, const Vector3& displacement); 
+
+    // builds the tree again top down from the current leaves, faster
+    // than moving a large share of the leaves one at a time
+    void Rebuild(); 
+
+    void Clear(); 
+
+    inline uint32 GetData(uint32 leaf) const { return nodes_[leaf].data; } 
+    inline void SetData(uint32 leaf, uint32 data) { nodes_[leaf].data = data; } 
+    inline const Aabb& GetBox(uint32 leaf) const { return nodes_[leaf].box; } 
+
+    inline uint32 GetLeafCount() const { return leafCount_; } 
+    inline int32 GetHeight() const { return root_ == NONE ? 0 : nodes_[root_].height; } 
+
+    inline float GetMargin() const { return margin_; } 
+    inline void SetMargin(float margin) { margin_ = margin; } 
+
+    // fn(data) for each leaf whose enlarged box overlaps the box, stops
+    // when fn returns false
+    template <class Fn> 
+    void Query(const Aabb& box, Fn&& fn) const 
+    {
+        Traverse([&](const Aabb& node) { return node.Overlaps(box); }, fn); 
+    }
+
+    // fn(data) for each leaf whose enlarged box overlaps the frustum
+    template <class Fn> 
+    void Query(const Frustum& frustum, Fn&& fn) const 
+    {
+        Traverse([&](const Aabb& node) { return frustum.Overlaps(node); }, fn); 
+    }
+
+    // fn(data, maxDistance) for each leaf the ray may hit, returns the
+    // new max distance so the closest hit can clip the rest of the search
+    template <class Fn> 
+    void Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, Fn&& fn) const 
+    {
+        Vector3 inv = InverseDirection(direction); 
+        Stack stack; 
+
+        if (root_ != NONE) stack.Push(root_); 
+
+        while (!stack.Empty()) 
+        {
+            const Node& node = nodes_[stack.Pop()]; 
+
+            if (node.box.Intersect(origin, inv, maxDistance) < 0) continue; 
+
+            if (node.IsLeaf()) 
+            {
+                maxDistance = fn(node.data, maxDistance); 
+                if (maxDistance < 0) return; 
+            }
+            else 
+            {
+                stack.Push(node.child1); 
+                stack.Push(node.child2); 
+            }
+        }
+    }
+
+    // 1 / direction, with large numbers instead of infinity
+    static Vector3 InverseDirection(const Vector3& direction); 
+
+private: 
+    struct Node 
+    {
+        Aabb box; 
+
+        // next free node while the node is free
+        uint32 parent = NONE; 
+        uint32 child1 = NONE; 
+        uint32 child2 = NONE; 
+
+        // leaf is 0, free is -1
+        int32 height = -1; 
+
+        uint32 data = 0; 
+
+        inline bool IsLeaf() const { return child1 == NONE; } 
+    };
+
+    // node stack that only allocates for very deep trees
+    class Stack 
+    {
+    public: 
+        inline bool Empty() const { return size_ == 0; } 
+
+        inline void Push(uint32 node) 
+        {
+            if (size_ < FIXED) fixed_[size_] = node; 
+            else more_.push_back(node); 
+
+            size_++; 
+        }
+
+        inline uint32 Pop() 
+        {
+            size_--; 
+
+            if (size_ < FIXED) return fixed_[size_]; 
+
+            uint32 node = more_.back(); 
+            more_.pop_back(); 
+            return node; 
+        }
+
+    private: 
+        static const uint32 FIXED = 64; 
+
+        uint32 fixed_[FIXED]; 
+        std::vector<uint32> more_; 
+        uint32 size_ = 0; 
+    };
+
+    template <class Test, class Fn> 
+    void Traverse(Test&& test, Fn& fn) const 
+    {
+        Stack stack; 
+
+        if (root_ != NONE) stack.Push(root_); 
+
+        while (!stack.Empty()) 
+        {
+            const Node& node = nodes_[stack.Pop()]; 
+
+            if (!test(node.box)) continue; 
+
+            if (node.IsLeaf()) 
+            {
+                if (!fn(node.data)) return; 
+            }
+            else 
+            {
+                stack.Push(node.child1); 
+                stack.Push(node.child2); 
+            }
+        }
+    }
+
+    Aabb Enlarge(const Aabb& box, const Vector3& displacement) const; 
+
+    uint32 AllocateNode(); 
+    void FreeNode(uint32 node); 
+
+    void InsertLeaf(uint32 leaf); 
+    void RemoveLeaf(uint32 leaf); 
+
+    // rotates the subtree if it is unbalanced, returns its new root
+    uint32 Balance(uint32 node); 
+
+    // builds a subtree over leaves [begin, end), returns its root
+    uint32 Build(uint32 begin, uint32 end); 
+
+    std::vector<Node> nodes_; 
+    uint32 root_; 
+    uint32 free_; 
+    uint32 leafCount_; 
+    float margin_; 
+
+    struct BuildLeaf 
+    {
+        Vector3 center; 
+        uint32 leaf; 
+    };
+
+    // leaves being rebuilt
+    std::vector<BuildLeaf> build_; 
+};
+
+// Box around the entity's world position that is kept in the
+// SpatialIndexSystem. Rotation and scale are not applied.
+struct OASIS_API SpatialBounds : public Component 
+{
+    Vector3 extents = Vector3(0.5f); 
+};
+
+// Keeps every entity with a WorldTransform and SpatialBounds in an
+// AabbTree for range, ray and frustum queries. Runs after the transform
+// hierarchy and only looks at entities whose transform or bounds
+// changed. When a large share of them leave their enlarged boxes in one
+// update the tree is rebuilt instead of moving them one by one.
+class OASIS_API SpatialIndexSystem : public EntitySystem 
+{
+public: 
+    // after the TransformHierarchySystem
+    static const int PRIORITY; 
+
+    // share of the entities added or leaving their boxes in one update
+    // above which the tree is rebuilt
+    static const float REBUILD_FRACTION; 
+
+    SpatialIndexSystem(); 
+
+    inline AabbTree& GetTree() { return tree_; } 
+    inline const AabbTree& GetTree() const { return tree_; } 
+
+    inline uint32 GetEntityCount() const { return entities_.size(); } 
+
+    // box from the last update, null if the entity is not indexed
+    const Aabb* GetBox(const EntityId& id) const; 
+
+    // fn(id) for each entity whose box overlaps the box
+    template <class Fn> 
+    void ForEachInBox(const Aabb& box, Fn fn) const 
+    {
+        tree_.Query(box, [&](uint32 slot) 
+        {
+            if (boxes_[slot].Overlaps(box)) fn(entities_[slot]); 
+            return true; 
+        }); 
+    }
+
+    // fn(id) for each entity whose box is within radius of the center
+    template <class Fn> 
+    void ForEachInSphere(const Vector3& center, float radius, Fn fn) const 
+    {
+        float radiusSq = radius * radius; 
+
+        tree_.Query(Aabb::FromCenter(center, Vector3(radius)), [&](uint32 slot) 
+        {
+            if (boxes_[slot].DistanceSq(center) <= radiusSq) fn(entities_[slot]); 
+            return true; 
+        }); 
+    }
+
+    // fn(id) for each entity whose box may be inside the frustum
+    template <class Fn> 
+    void ForEachInFrustum(const Frustum& frustum, Fn fn) const 
+    {
+        tree_.Query(frustum, [&](uint32 slot) 
+        {
+            if (frustum.Overlaps(boxes_[slot])) fn(entities_[slot]); 
+            return true; 
+        }); 
+    }
+
+    // fn(id, distance) for each entity the ray hits, in no order
+    template <class Fn> 
+    void ForEachOnRay(const Vector3& origin, const Vector3& direction, float maxDistance, Fn fn) const 
+    {
+        Vector3 inv = AabbTree::InverseDirection(direction); 
+
+        tree_.Raycast(origin, direction, maxDistance, [&](uint32 slot, float max) 
+        {
+            float distance = boxes_[slot].Intersect(origin, inv, max); 
+            if (distance >= 0) fn(entities_[slot], distance); 
+            return max; 
+        }); 
+    }
+
+    // closest entity the ray hits, distance is in units of direction
+    bool Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, EntityId& hit, float& distance) const; 
+
+protected: 
+    void OnUpdate(Scene& scene, uint32 count, const EntityId* entities, float dt) override; 
+
+private: 
+    // adds, moves and removes entities after a structural change
+    void Sync(); 
+
+    // moves entities whose transform or bounds changed
+    void Refit(); 
+
+    // true if the box left its leaf, which is then moved by Flush
+    bool Update(uint32 slot, const Aabb& box); 
+
+    // the leaf is made by Flush
+    void Add(const EntityId& id, const Aabb& box); 
+    void Remove(uint32 slot); 
+
+    // moves the escaped leaves and inserts the added ones, or rebuilds
+    // the tree if there are many
+    void Flush(); 
+
+    int32 GetSlot(const EntityId& id) const; 
+
+    static Aabb GetBox(const WorldTransform& world, const SpatialBounds& bounds); 
+
+    AabbTree tree_; 
+
+    // indexed by slot, the tree leaves hold slots
+    std::vector<EntityId> entities_; 
+    std::vector<Aabb> boxes_; 
+    std::vector<uint32> leaves_; 
+    std::vector<uint32> seen_; 
+
+    // slot by entity id, -1 if not indexed
+    std::vector<int32> slots_; 
+
+    // entities found by Sync, added once the missing ones are removed
+    std::vector<EntityId> added_; 
+    std::vector<Aabb> addedBoxes_; 
+
+    // leaves whose box left them and how far it moved
+    std::vector<uint32> escaped_; 
+    std::vector<Vector3> displacements_; 
+
+    uint32 stamp_ = 0; 
+
+    std::vector<ClassId> changed_; 
+};
+
+}
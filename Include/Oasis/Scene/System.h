@@ -1,13 +1,26 @@
 #pragma once 
 
 #include "Oasis/Common.h" 
+#include "Oasis/Core/Telemetry.h" 
 #include "Oasis/Scene/Filter.h" 
+#include "Oasis/Scene/Query.h" 
+
+#include <algorithm> 
 
 namespace Oasis
 {
 
+class RenderState; 
 class Scene; 
 
+enum class ComponentAccess 
+{
+    READ = 0, 
+    WRITE = 1, 
+
+    count 
+};
+
 class OASIS_API EntitySystem 
 {
 public: 
@@ -21,10 +34,30 @@ public:
 
     inline int GetPriority() const { return priority_; } 
 
+    // type name of the system unless set, names its profile zones
+    inline const std::string& GetName() const { return name_; } 
+    void SetName(const std::string& name); 
+
+    // average time of Update, and of Render or Draw, read them from
+    // the thread that runs the system
+    inline const AverageTime& GetUpdateTime() const { return updateTime_; } 
+    inline const AverageTime& GetRenderTime() const { return renderTime_; } 
+
     void Update(float dt); 
 
     void Render(); 
 
+    // copies what the system draws to the state, after an update
+    void Extract(RenderState& state); 
+
+    // draws an extracted state, without touching the scene
+    void Draw(const RenderState& state); 
+
+    inline bool HasDeclaredAccess() const { return declaresAccess_; } 
+
+    // true if the systems cannot update at the same time
+    bool ConflictsWith(const EntitySystem& other) const; 
+
 protected: 
     virtual void OnAdded() {}  
 
@@ -34,6 +67,15 @@ protected:
 
     virtual void OnRender(Scene& scene, uint32 count, const EntityId* entities);  
 
+    // Used instead of OnRender when the engine is pipelined. OnExtract
+    // runs after each tick and copies what OnDraw needs from the
+    // components to the state. OnDraw then draws the state on the render
+    // thread while the scene updates the next tick, so it must only read
+    // the state and what the system itself owns.
+    virtual void OnExtract(Scene& scene, uint32 count, const EntityId* entities, RenderState& state); 
+
+    virtual void OnDraw(const RenderState& state); 
+
     template <class T> 
     void Include() 
     {
@@ -46,6 +88,114 @@ protected:
         filter_.Exclude<T>(); 
     }
 
+    // Read and Write include the component like Include, and also
+    // declare how the system uses it. A system that declares its access
+    // must only touch the declared components, and may then run at the
+    // same time as other systems that do not write what it reads or
+    // read what it writes. Systems that declare nothing run alone.
+    template <class T> 
+    void Read() 
+    {
+        Include<T>(); 
+        DeclareAccess(GetClassId<T>(), ComponentAccess::READ); 
+    }
+
+    template <class T> 
+    void Write() 
+    {
+        Include<T>(); 
+        DeclareAccess(GetClassId<T>(), ComponentAccess::WRITE); 
+    }
+
+    // declares access to a component without filtering on it, for
+    // components looked up on other entities
+    template <class T> 
+    void Access(ComponentAccess access) 
+    {
+        DeclareAccess(GetClassId<T>(), access); 
+    }
+
+    void DeclareAccess(ClassId compId, ComponentAccess access); 
+
+    // Includes the component like Include, and limits the system's
+    // queries to entities where one of the Changed components was
+    // created or written since the system last ran (update and render
+    // are tracked separately). The entities passed to OnUpdate and
+    // OnRender are not limited.
+    template <class T> 
+    void Changed() 
+    {
+        Include<T>(); 
+
+        if (std::find(changed_.begin(), changed_.end(), GetClassId<T>()) == changed_.end()) 
+        {
+            changed_.push_back(GetClassId<T>()); 
+        }
+    }
+
+    // query over the entities matching this system's filter, only
+    // valid while the system is added to a scene
+    template <class... Components> 
+    EntityQuery<Components...> Query() 
+    {
+        return EntityQuery<Components...>(GetEntityManager(), GetArchetypes(), 
+            changeVersion_ ? changeVersion_ : GetEntityManager().GetChangeVersion(), 
+            changedSince_, changed_.empty() ? nullptr : &changed_); 
+    }
+
+    // Same as Query, but limited to entities where one of the changed
+    // components was written since the system last ran, independent of
+    // Changed. The list must outlive the query.
+    template <class... Components> 
+    EntityQuery<Components...> QueryChanged(const std::vector<ClassId>& changed) 
+    {
+        return EntityQuery<Components...>(GetEntityManager(), GetArchetypes(), 
+            changeVersion_ ? changeVersion_ : GetEntityManager().GetChangeVersion(), 
+            changedSince_, &changed); 
+    }
+
+    // fn(Components&...) for each matching entity
+    template <class... Components, class Fn> 
+    void ForEach(Fn fn) 
+    {
+        Query<Components...>().ForEach(fn); 
+    }
+
+    // fn(const EntityId&, Components&...) for each matching entity
+    template <class... Components, class Fn> 
+    void ForEachEntity(Fn fn) 
+    {
+        Query<Components...>().ForEachEntity(fn); 
+    }
+
+    // fn(Components&...) for each matching entity, split by chunk
+    // across the job system's threads
+    template <class... Components, class Fn> 
+    void ParallelForEach(Fn fn) 
+    {
+        Query<Components...>().ParallelForEach(GetJobSystem(), fn); 
+    }
+
+    // Calls fn(begin, end) over [0, count) split into ranges across the
+    // job system's threads, for example over the entities passed to
+    // OnUpdate. Structural changes made by fn are recorded to the
+    // running thread's command buffer and applied after the system.
+    void ParallelFor(uint32 count, const JobSystem::RangeJob& fn, uint32 grainSize = 0); 
+
+    // job system of the scene manager, may be null
+    JobSystem* GetJobSystem(); 
+
+    EntityManager& GetEntityManager(); 
+
+    // command buffer for the calling thread, played back after the system runs
+    EntityCommandBuffer& GetCommandBuffer(); 
+
+    const std::vector<EntityArchetype*>& GetArchetypes() const; 
+
+    // whether an entity entered or left the system's archetypes since
+    // the last call, or since the system was added to its scene
+    bool StructureChanged(); 
+
 private: 
     friend class EntitySystemManager; 
 
@@ -53,8 +203,34 @@ private:
 
     int32 priority_ = DEFAULT_PRIORITY; 
     Scene* scene_ = nullptr; 
+
+    std::string name_; 
+    const char* updateZone_ = nullptr; 
+    const char* renderZone_ = nullptr; 
+    const char* extractZone_ = nullptr; 
+    const char* drawZone_ = nullptr; 
+
+    AverageTime updateTime_; 
+    AverageTime renderTime_; 
     EntityFilter filter_; 
     uint32 filterId_ = 0; 
+
+    bool declaresAccess_ = false; 
+    std::vector<ClassId> reads_; 
+    std::vector<ClassId> writes_; 
+
+    std::vector<ClassId> changed_; 
+
+    // change version of the current run and the one its queries compare against
+    uint32 changeVersion_ = 0; 
+    uint32 changedSince_ = 0; 
+    uint32 lastUpdateVersion_ = 0; 
+    uint32 lastRenderVersion_ = 0; 
+
+    // sum of the structure versions of the filtered archetypes, seen
+    // by the last StructureChanged
+    uint64 structureVersion_ = 0; 
+    uint32 archetypeCount_ = 0; 
 }; 
 
 }
\ No newline at end of file
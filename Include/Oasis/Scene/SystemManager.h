@@ -7,6 +7,7 @@ namespace Oasis
 
 class EntityManager; 
 class EntitySystem; 
+class RenderState; 
 class Scene; 
 
 class OASIS_API EntitySystemManager 
@@ -22,9 +23,23 @@ public:
     bool RemoveSystem(EntitySystem* system); 
     bool SetSystemEnabled(EntitySystem* system, bool enabled = true); 
 
+    inline uint32 GetSystemCount() const { return systems_.size(); } 
+    inline EntitySystem* GetSystem(uint32 index) { return systems_[index].system; } 
+
+    // Systems are updated in priority order, except that systems which
+    // declared non-conflicting component access are grouped into batches
+    // and updated at the same time on the scene manager's job system.
+    // Structural changes made by a batch are applied once it finishes.
+    // Systems must not be added or removed from a batched system.
     void Update(float dt); 
+
+    // always runs on the calling thread
     void Render(); 
 
+    // extracts every enabled system in priority order, which is the
+    // order they draw the state in
+    void Extract(RenderState& state); 
+
 private: 
     struct Entry 
     {
@@ -38,6 +53,7 @@ private:
     };
 
     bool SortSystems(); 
+    void BuildBatches(); 
 
     Entry* FindSystemEntry(EntitySystem* system); 
     int FindSystemIndex(EntitySystem* system); 
@@ -46,6 +62,12 @@ private:
     EntityManager& entityManager_; 
     std::vector<Entry> systems_; 
     bool sorted_ = true; 
+
+    // systems of the batch being updated, kept to not allocate every tick
+    std::vector<EntitySystem*> run_; 
+
+    // indices into systems_, the systems in a batch do not conflict
+    std::vector<std::vector<uint32>> batches_; 
 };
 
 }
\ No newline at end of file
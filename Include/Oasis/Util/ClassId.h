@@ -2,17 +2,55 @@
 
 #include "Oasis/Common.h"
 
+#include <type_traits> 
 #include <typeinfo> 
 
 namespace Oasis 
 {
 
-using ClassId = unsigned long long; 
+struct Component; 
+class Event; 
+
+// Dense index of a type within its family, starting at 0, so it can be
+// used to index arrays and bitsets directly. Components and events each
+// have their own family, other types share the default one.
+using ClassId = uint32; 
+
+enum class ClassFamily 
+{
+    DEFAULT = 0, 
+    COMPONENT = 1, 
+    EVENT = 2, 
+
+    count 
+};
+
+template <class T> 
+struct ClassFamilyOf 
+{
+    static const ClassFamily value = 
+        std::is_base_of<Component, T>::value ? ClassFamily::COMPONENT : 
+        std::is_base_of<Event, T>::value ? ClassFamily::EVENT : 
+        ClassFamily::DEFAULT; 
+};
+
+// Assigns the next id of the family to a type, or returns the id it
+// already has. Types are matched by name so every module that asks
+// for a type gets the same id. Thread safe.
+OASIS_API ClassId RegisterClassId(ClassFamily family, const std::type_info& type); 
+
+// number of ids assigned in a family so far
+OASIS_API uint32 GetClassIdCount(ClassFamily family); 
+
+// readable name of a type, such as "Oasis::Transform" 
+OASIS_API std::string GetTypeName(const std::type_info& type); 
 
 template <class T> 
 OASIS_API ClassId GetClassId() 
 {
-    return reinterpret_cast<ClassId>(&typeid(T)); 
+    // only the first call for each type goes to the registry
+    static const ClassId id = RegisterClassId(ClassFamilyOf<T>::value, typeid(T)); 
+    return id; 
 }
 
 template <class T> 
@@ -21,4 +59,4 @@ OASIS_API ClassId GetClassId(const T& value)
     return GetClassId<T>(); 
 }
 
-}
\ No newline at end of file
+}
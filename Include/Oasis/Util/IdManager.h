@@ -5,6 +5,10 @@
 namespace Oasis 
 {
 
+// Hands out small integer ids, reusing released ones. Released ids
+// form an intrusive free list (each free slot stores the next free
+// id) and validity is a bitset, so Get, Release and IsValid are O(1)
+// and do not allocate once the id range has been reached.
 template <class T> 
 class OASIS_API IdManager 
 {
@@ -16,40 +20,67 @@ public:
 
     Id Size() const { return size_; } 
 
+    // number of ids currently handed out
+    Id Count() const { return count_; } 
+
     Id Get() 
     {
-        if (released_.size()) 
+        Id id; 
+
+        if (freeHead_ != NONE) 
         {
             // there is released id, use that 
-            Id id = *released_.begin(); 
-            released_.erase(released_.begin()); 
-            return id; 
+            id = freeHead_; 
+            freeHead_ = next_[id]; 
         }
         else 
         {
-            return size_++; 
+            id = size_++; 
+            next_.push_back(NONE); 
+
+            if ((id >> 6) >= valid_.size()) 
+            {
+                valid_.push_back(0); 
+            }
         }
+
+        valid_[id >> 6] |= Bit(id); 
+        count_++; 
+        return id; 
     }
 
     bool Release(Id id) 
     {
         if (!IsValid(id)) return false; 
 
-        released_.insert(id); 
+        valid_[id >> 6] &= ~Bit(id); 
+        next_[id] = freeHead_; 
+        freeHead_ = id; 
+        count_--; 
         return true; 
     }
 
     bool IsValid(Id id) const 
     {
-        return id >= 0 && id < size_ && released_.find(id) == released_.end(); 
+        return id < size_ && (valid_[id >> 6] & Bit(id)) != 0; 
     }
 
 private: 
+    static const Id NONE = ~Id(0); 
+
+    static inline uint64 Bit(Id id) { return uint64(1) << (id & 63); } 
+
     Id size_ = 0; 
-    std::set<Id> released_; 
+    Id count_ = 0; 
+    Id freeHead_ = NONE; 
+    std::vector<Id> next_; 
+    std::vector<uint64> valid_; 
 };
 
+template <class T> 
+const typename IdManager<T>::Id IdManager<T>::NONE; 
+
 using IdManager32 = IdManager<uint32>; 
 using IdManager64 = IdManager<uint64>; 
 
-}
\ No newline at end of file
+}
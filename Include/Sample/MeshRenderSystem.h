@@ -11,9 +11,16 @@ public:
 
     void OnRender(Scene& scene, uint32 count, const EntityId* entities) override; 
 
+    void OnExtract(Scene& scene, uint32 count, const EntityId* entities, RenderState& state) override; 
+
+    void OnDraw(const RenderState& state) override; 
+
 private: 
     void CreateResources(); 
 
     Shader* shader_; 
     Texture2D* texture_; 
+
+    // reused by OnRender when not pipelined
+    RenderState state_; 
 };
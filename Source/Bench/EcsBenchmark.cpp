@@ -0,0 +1,581 @@
+// Headless microbenchmarks for the entity component system. Every
+// benchmark is run at several entity counts and reports the time and
+// number of heap allocations (operator new) per operation, and the
+// archetype chunks and pool pages allocated per operation, which use
+// malloc and are counted by MemoryTracker under COMPONENTS. Command
+// buffer pages are kept between recordings and are not counted.
+//
+// OasisBench [--format text|csv|json] [--sizes 1000,100000] [--repeat n]
+//            [--threads n] [--filter name]
+
+#include "Oasis/Core/JobSystem.h" 
+#include "Oasis/Core/MemoryTracker.h" 
+#include "Oasis/Scene/EntityManager.h" 
+#include "Oasis/Scene/Scene.h" 
+#include "Oasis/Scene/SceneManager.h" 
+#include "Oasis/Scene/System.h" 
+
+#include <algorithm> 
+#include <atomic> 
+#include <chrono> 
+#include <cstdio> 
+#include <cstring> 
+#include <iostream> 
+#include <new> 
+#include <random> 
+#include <sstream> 
+
+using namespace Oasis; 
+
+namespace 
+{
+    std::atomic<uint64> allocationCount(0); 
+}
+
+void* operator new(std::size_t size) 
+{
+    allocationCount++; 
+
+    void* p = std::malloc(size ? size : 1); 
+    if (!p) throw std::bad_alloc(); 
+
+    return p; 
+}
+
+void operator delete(void* p) noexcept 
+{
+    std::free(p); 
+}
+
+struct Position : public Component 
+{
+    float x = 0, y = 0, z = 0; 
+};
+
+struct Velocity : public Component 
+{
+    float x = 1, y = 1, z = 1; 
+};
+
+struct Health : public Component 
+{
+    int32 value = 100; 
+};
+
+struct Marker : public Component 
+{
+    uint32 value = 0; 
+};
+
+namespace 
+{
+
+enum class OutputFormat 
+{
+    TEXT, 
+    CSV, 
+    JSON 
+};
+
+struct Options 
+{
+    OutputFormat format = OutputFormat::TEXT; 
+    std::vector<uint32> sizes = { 1000, 100000, 1000000 }; 
+    uint32 repeat = 3; 
+    int threads = -1; 
+    std::string filter; 
+};
+
+struct Result 
+{
+    std::string name; 
+    uint32 entities; 
+    uint64 ops; 
+    double nsPerOp; 
+    double allocationsPerOp; 
+    double storageAllocationsPerOp; 
+};
+
+// Collects the best of every repeat of a benchmark
+class Reporter 
+{
+public: 
+    explicit Reporter(const Options& options) : options_(options) {} 
+
+    // times fn, which performs ops operations on a set of n entities
+    template <class Fn> 
+    void Measure(const char* name, uint32 n, uint64 ops, Fn fn) 
+    {
+        uint64 storage = GetStorageAllocations(); 
+        uint64 allocations = allocationCount.load(); 
+        auto start = std::chrono::steady_clock::now(); 
+
+        fn(); 
+
+        auto end = std::chrono::steady_clock::now(); 
+        allocations = allocationCount.load() - allocations; 
+        storage = GetStorageAllocations() - storage; 
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count(); 
+        Add(name, n, ops ? ops : 1, ns, allocations, storage); 
+    }
+
+    void Write(std::ostream& out) const; 
+
+private: 
+    // archetype chunks and pool pages, ARCHETYPES counts under COMPONENTS
+    static uint64 GetStorageAllocations() 
+    {
+        return MemoryTracker::GetStats(MemoryTracker::COMPONENTS).allocations; 
+    }
+
+    void Add(const char* name, uint32 n, uint64 ops, double ns, uint64 allocations, uint64 storage) 
+    {
+        for (auto& r : results_) 
+        {
+            if (r.name == name && r.entities == n) 
+            {
+                r.nsPerOp = std::min(r.nsPerOp, ns / ops); 
+                r.allocationsPerOp = std::min(r.allocationsPerOp, (double) allocations / ops); 
+                r.storageAllocationsPerOp = std::min(r.storageAllocationsPerOp, (double) storage / ops); 
+                return; 
+            }
+        }
+
+        results_.push_back({ name, n, ops, ns / ops, (double) allocations / ops, (double) storage / ops }); 
+    }
+
+    const Options& options_; 
+    std::vector<Result> results_; 
+};
+
+void Reporter::Write(std::ostream& out) const 
+{
+    char line[256]; 
+
+    switch (options_.format) 
+    {
+    case OutputFormat::TEXT: 
+        std::snprintf(line, sizeof (line), "%-24s %10s %12s %12s %10s %10s\n", "benchmark", "entities", "ops", "ns/op", "allocs/op", "storage/op"); 
+        out << line; 
+
+        for (auto& r : results_) 
+        {
+            std::snprintf(line, sizeof (line), "%-24s %10u %12llu %12.2f %10.3f %10.4f\n", 
+                r.name.c_str(), r.entities, (unsigned long long) r.ops, r.nsPerOp, r.allocationsPerOp, r.storageAllocationsPerOp); 
+            out << line; 
+        }
+        break; 
+
+    case OutputFormat::CSV: 
+        out << "benchmark,entities,ops,ns_per_op,allocs_per_op,storage_allocs_per_op\n"; 
+
+        for (auto& r : results_) 
+        {
+            std::snprintf(line, sizeof (line), "%s,%u,%llu,%.3f,%.4f,%.4f\n", 
+                r.name.c_str(), r.entities, (unsigned long long) r.ops, r.nsPerOp, r.allocationsPerOp, r.storageAllocationsPerOp); 
+            out << line; 
+        }
+        break; 
+
+    case OutputFormat::JSON: 
+        out << "[\n"; 
+
+        for (uint32 i = 0; i < results_.size(); i++) 
+        {
+            const Result& r = results_[i]; 
+
+            std::snprintf(line, sizeof (line), 
+                "  { \"benchmark\": \"%s\", \"entities\": %u, \"ops\": %llu, \"ns_per_op\": %.3f, \"allocs_per_op\": %.4f, \"storage_allocs_per_op\": %.4f }%s\n", 
+                r.name.c_str(), r.entities, (unsigned long long) r.ops, r.nsPerOp, r.allocationsPerOp, r.storageAllocationsPerOp, 
+                i + 1 < results_.size() ? "," : ""); 
+            out << line; 
+        }
+
+        out << "]\n"; 
+        break; 
+    }
+}
+
+// keeps the optimizer from dropping reads
+volatile uint64 sink = 0; 
+
+void BenchCreate(Reporter& reporter, uint32 n) 
+{
+    {
+        EntityManager em; 
+        std::vector<EntityId> ids(n); 
+
+        reporter.Measure("create", n, n, [&]() 
+        {
+            for (uint32 i = 0; i < n; i++) 
+            {
+                ids[i] = em.CreateEntityId(); 
+                em.AttachComponent<Position>(ids[i]); 
+                em.AttachComponent<Velocity>(ids[i]); 
+            }
+        }); 
+    }
+
+    {
+        EntityManager em; 
+        std::vector<EntityId> ids(n); 
+
+        reporter.Measure("create_bulk", n, n, [&]() 
+        {
+            em.CreateEntities<Position, Velocity>(n, &ids[0]); 
+        }); 
+    }
+}
+
+void BenchDestroy(Reporter& reporter, uint32 n) 
+{
+    {
+        EntityManager em; 
+        std::vector<EntityId> ids(n); 
+        em.CreateEntities<Position, Velocity>(n, &ids[0]); 
+
+        reporter.Measure("destroy", n, n, [&]() 
+        {
+            for (uint32 i = 0; i < n; i++) 
+            {
+                em.DestroyEntityId(ids[i]); 
+            }
+        }); 
+    }
+
+    {
+        EntityManager em; 
+        std::vector<EntityId> ids(n); 
+        em.CreateEntities<Position, Velocity>(n, &ids[0]); 
+
+        reporter.Measure("destroy_bulk", n, n, [&]() 
+        {
+            em.DestroyEntities(&ids[0], n); 
+        }); 
+    }
+}
+
+void BenchAttachDetach(Reporter& reporter, uint32 n) 
+{
+    EntityManager em; 
+    std::vector<EntityId> ids(n); 
+    em.CreateEntities<Position, Velocity>(n, &ids[0]); 
+
+    reporter.Measure("attach", n, n, [&]() 
+    {
+        for (uint32 i = 0; i < n; i++) 
+        {
+            em.AttachComponent<Health>(ids[i]); 
+        }
+    }); 
+
+    reporter.Measure("detach", n, n, [&]() 
+    {
+        for (uint32 i = 0; i < n; i++) 
+        {
+            em.DetachComponent<Health>(ids[i]); 
+        }
+    }); 
+}
+
+void BenchGetComponent(Reporter& reporter, uint32 n) 
+{
+    EntityManager em; 
+    std::vector<EntityId> ids(n); 
+    em.CreateEntities<Position, Velocity>(n, &ids[0]); 
+
+    reporter.Measure("get_component", n, n, [&]() 
+    {
+        uint64 sum = 0; 
+        for (uint32 i = 0; i < n; i++) 
+        {
+            sum += (uint64) em.GetComponent<Velocity>(ids[i])->x; 
+        }
+        sink = sum; 
+    }); 
+
+    // cache misses dominate once the entities do not fit in cache
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(1234)); 
+
+    reporter.Measure("get_component_random", n, n, [&]() 
+    {
+        uint64 sum = 0; 
+        for (uint32 i = 0; i < n; i++) 
+        {
+            sum += (uint64) em.GetComponent<Velocity>(ids[i])->x; 
+        }
+        sink = sum; 
+    }); 
+}
+
+// filters in the shape systems usually have, most match some of the entities
+void AddFilters(EntityManager& em) 
+{
+    EntityFilter filters[8]; 
+
+    filters[0].Include<Position>(); 
+    filters[1].Include<Position>().Include<Velocity>(); 
+    filters[2].Include<Velocity>(); 
+    filters[3].Include<Health>(); 
+    filters[4].Include<Position>().Exclude<Health>(); 
+    filters[5].Include<Marker>(); 
+    filters[6].Include<Position>().Include<Marker>(); 
+    filters[7].Include<Velocity>().Exclude<Marker>(); 
+
+    for (auto& filter : filters) 
+    {
+        em.GetFilterCache().GetFilterId(filter); 
+    }
+}
+
+void BenchFilters(Reporter& reporter, uint32 n) 
+{
+    {
+        EntityManager em; 
+        AddFilters(em); 
+        std::vector<EntityId> ids(n); 
+
+        reporter.Measure("filter_create", n, n, [&]() 
+        {
+            for (uint32 i = 0; i < n; i++) 
+            {
+                ids[i] = em.CreateEntityId(); 
+                em.AttachComponent<Position>(ids[i]); 
+                em.AttachComponent<Velocity>(ids[i]); 
+            }
+        }); 
+
+        reporter.Measure("filter_attach", n, n, [&]() 
+        {
+            for (uint32 i = 0; i < n; i++) 
+            {
+                em.AttachComponent<Marker>(ids[i]); 
+            }
+        }); 
+
+        reporter.Measure("filter_destroy", n, n, [&]() 
+        {
+            for (uint32 i = 0; i < n; i++) 
+            {
+                em.DestroyEntityId(ids[i]); 
+            }
+        }); 
+    }
+
+    {
+        EntityManager em; 
+        std::vector<EntityId> ids(n); 
+        em.CreateEntities<Position, Velocity>(n, &ids[0]); 
+
+        // a new filter has to collect the entities that already exist
+        reporter.Measure("filter_register", n, 1, [&]() 
+        {
+            EntityFilter filter; 
+            filter.Include<Velocity>().Exclude<Health>(); 
+            em.GetFilterCache().GetFilterId(filter); 
+        }); 
+    }
+}
+
+class MoveSystem : public EntitySystem 
+{
+public: 
+    MoveSystem() 
+    {
+        Write<Position>(); 
+        Read<Velocity>(); 
+    }
+
+protected: 
+    void OnUpdate(Scene& scene, uint32 count, const EntityId* entities, float dt) override 
+    {
+        (void) scene; 
+        (void) count; 
+        (void) entities; 
+
+        ForEach<Position, const Velocity>([=](Position& p, const Velocity& v) 
+        {
+            p.x += v.x * dt; 
+            p.y += v.y * dt; 
+            p.z += v.z * dt; 
+        }); 
+    }
+};
+
+void BenchIterate(Reporter& reporter, uint32 n, JobSystem& jobs) 
+{
+    SceneManager sceneManager; 
+    sceneManager.SetJobSystem(&jobs); 
+
+    Scene* scene = sceneManager.CreateScene("Benchmark"); 
+    EntityManager& em = scene->GetEntityManager(); 
+
+    std::vector<EntityId> ids(n); 
+    em.CreateEntities<Position, Velocity>(n, &ids[0]); 
+
+    EntityFilter filter; 
+    filter.Include<Position>().Include<Velocity>(); 
+    uint32 filterId = em.GetFilterCache().GetFilterId(filter); 
+    const std::vector<EntityArchetype*>& archetypes = em.GetFilterCache().GetArchetypes(filterId); 
+
+    reporter.Measure("foreach", n, n, [&]() 
+    {
+        EntityQuery<Position, const Velocity>(em, archetypes).ForEach([](Position& p, const Velocity& v) 
+        {
+            p.x += v.x; 
+            p.y += v.y; 
+            p.z += v.z; 
+        }); 
+    }); 
+
+    reporter.Measure("foreach_read", n, n, [&]() 
+    {
+        float sum = 0; 
+        EntityQuery<const Position>(em, archetypes).ForEach([&](const Position& p) { sum += p.x; }); 
+        sink = (uint64) sum; 
+    }); 
+
+    // nothing changed since the version, so every chunk is skipped
+    std::vector<ClassId> changed = { GetClassId<Velocity>() }; 
+    uint32 since = em.NextChangeVersion(); 
+
+    reporter.Measure("foreach_unchanged", n, n, [&]() 
+    {
+        float sum = 0; 
+        EntityQuery<const Position>(em, archetypes, em.GetChangeVersion(), since, &changed).ForEach([&](const Position& p) { sum += p.x; }); 
+        sink = (uint64) sum; 
+    }); 
+
+    reporter.Measure("parallel_foreach", n, n, [&]() 
+    {
+        EntityQuery<Position, const Velocity>(em, archetypes).ParallelForEach(&jobs, [](Position& p, const Velocity& v) 
+        {
+            p.x += v.x; 
+            p.y += v.y; 
+            p.z += v.z; 
+        }); 
+    }); 
+
+    scene->AddSystem(new MoveSystem()); 
+
+    // first update sorts the systems
+    scene->Update(0.01f); 
+
+    reporter.Measure("system_update", n, n, [&]() 
+    {
+        scene->Update(0.01f); 
+    }); 
+
+    em.GetFilterCache().ReleaseFilterId(filterId); 
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) 
+{
+    for (int i = 1; i < argc; i++) 
+    {
+        std::string arg = argv[i]; 
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr; 
+
+        if (arg == "--format" && value) 
+        {
+            std::string f = argv[++i]; 
+
+            if (f == "text") options.format = OutputFormat::TEXT; 
+            else if (f == "csv") options.format = OutputFormat::CSV; 
+            else if (f == "json") options.format = OutputFormat::JSON; 
+            else return false; 
+        }
+        else if (arg == "--sizes" && value) 
+        {
+            options.sizes.clear(); 
+
+            std::stringstream list(argv[++i]); 
+            std::string size; 
+
+            while (std::getline(list, size, ',')) 
+            {
+                int n = std::atoi(size.c_str()); 
+                if (n > 0) options.sizes.push_back(n); 
+            }
+
+            if (options.sizes.empty()) return false; 
+        }
+        else if (arg == "--repeat" && value) 
+        {
+            options.repeat = std::max(1, std::atoi(argv[++i])); 
+        }
+        else if (arg == "--threads" && value) 
+        {
+            options.threads = std::atoi(argv[++i]); 
+        }
+        else if (arg == "--filter" && value) 
+        {
+            options.filter = argv[++i]; 
+        }
+        else 
+        {
+            return false; 
+        }
+    }
+
+    return true; 
+}
+
+}
+
+int main(int argc, char** argv) 
+{
+    Options options; 
+
+    if (!ParseOptions(argc, argv, options)) 
+    {
+        std::cerr << "usage: " << argv[0] << " [--format text|csv|json] [--sizes 1000,100000] [--repeat n] [--threads n] [--filter name]" << std::endl; 
+        std::cerr << "filters: create, destroy, attach, get, filter, iterate" << std::endl; 
+
+        return argc == 2 && std::strcmp(argv[1], "--help") == 0 ? 0 : 1; 
+    }
+
+    // results go to stdout, keep it machine readable
+    Logger::SetOutput(&std::cerr); 
+    Logger::SetLevel(LogLevel::WARNING); 
+
+#if defined(__GNUC__) && !defined(__OPTIMIZE__) 
+    Logger::Warning("OasisBench: Built without optimizations, use CMAKE_BUILD_TYPE=RELEASE"); 
+#endif 
+
+    JobSystem jobs(options.threads < 0 ? JobSystem::GetDefaultWorkerCount() : options.threads); 
+    Reporter reporter(options); 
+
+    struct Group 
+    {
+        const char* name; 
+        std::function<void(Reporter&, uint32)> run; 
+    };
+
+    std::vector<Group> groups = { 
+        { "create", BenchCreate }, 
+        { "destroy", BenchDestroy }, 
+        { "attach", BenchAttachDetach }, 
+        { "get", BenchGetComponent }, 
+        { "filter", BenchFilters }, 
+        { "iterate", [&](Reporter& r, uint32 n) { BenchIterate(r, n, jobs); } }, 
+    };
+
+    for (uint32 size : options.sizes) 
+    {
+        for (auto& group : groups) 
+        {
+            if (!options.filter.empty() && options.filter != group.name) continue; 
+
+            for (uint32 i = 0; i < options.repeat; i++) 
+            {
+                group.run(reporter, size); 
+            }
+        }
+    }
+
+    reporter.Write(std::cout); 
+
+    return 0; 
+}
@@ -2,8 +2,18 @@
 
 #include "Oasis/Core/Application.h" 
 #include "Oasis/Core/Display.h" 
+#include "Oasis/Core/EventManager.h" 
+#include "Oasis/Core/JobSystem.h" 
+#include "Oasis/Core/MemoryTracker.h" 
+#include "Oasis/Core/FrameArena.h" 
+#include "Oasis/Core/FramePacer.h" 
+#include "Oasis/Core/Profiler.h" 
+#include "Oasis/Core/Telemetry.h" 
+#include "Oasis/Core/TimeUtil.h" 
 #include "Oasis/Core/Timer.h" 
 #include "Oasis/Graphics/GL/GLGraphicsDevice.h" 
+#include "Oasis/Graphics/Null/NullGraphicsDevice.h" 
+#include "Oasis/Graphics/RenderState.h" 
 #include "Oasis/Scene/Scene.h" 
 #include "Oasis/Scene/SceneManager.h" 
 
@@ -12,15 +22,27 @@ using namespace std;
 namespace Oasis
 {
 
+namespace 
+{
+    // hitch threshold when there is no target rate to derive it from
+    const double DEFAULT_HITCH_SECONDS = 0.1; 
+}
+
 float Engine::ups_ = 0; 
 float Engine::fps_ = 0; 
+float Engine::frameTime_ = 0; 
 Application* Engine::app_ = nullptr; 
-bool Engine::running_ = false; 
+std::atomic<bool> Engine::running_(false); 
+uint64 Engine::totalTicks_ = 0; 
 Config Engine::config_; 
 
 Display* Engine::display_ = nullptr; 
 GraphicsDevice* Engine::graphics_ = nullptr; 
 SceneManager* Engine::sceneManager_ = nullptr; 
+JobSystem* Engine::jobSystem_ = nullptr; 
+EventManager* Engine::eventManager_ = nullptr; 
+Telemetry* Engine::telemetry_ = nullptr; 
+RenderStateBuffer* Engine::renderStates_ = nullptr; 
 
 int Engine::Start(Application* app)
 {
@@ -44,11 +66,67 @@ int Engine::Start(Application* app)
 
     running_ = true;
 
-    display_ = new Display(); 
-    graphics_ = new GLGraphicsDevice(); 
+    // before the job system starts other threads that log
+    if (config_.asyncLogging) Logger::SetAsync(true); 
+
+    totalTicks_ = 0; 
+
+    if (config_.graphicsBackend == GraphicsBackend::NONE) 
+    {
+        Logger::Info("Running headless"); 
+        graphics_ = new NullGraphicsDevice(); 
+    }
+    else 
+    {
+        display_ = new Display(); 
+        graphics_ = new GLGraphicsDevice(); 
+    }
     sceneManager_ = new SceneManager(); 
+    eventManager_ = new EventManager(); 
 
-    return GameLoop();
+    if (config_.workerThreads < 0) 
+    {
+        jobSystem_ = new JobSystem(); 
+    }
+    else 
+    {
+        jobSystem_ = new JobSystem(config_.workerThreads); 
+    }
+    sceneManager_->SetJobSystem(jobSystem_); 
+
+    double hitchSeconds = config_.hitchSeconds; 
+    if (hitchSeconds <= 0) 
+    {
+        double rate = config_.targetFps > 0 ? config_.targetFps : config_.targetUps; 
+        hitchSeconds = rate > 0 ? 2.0 / rate : DEFAULT_HITCH_SECONDS; 
+    }
+    telemetry_ = new Telemetry(hitchSeconds); 
+
+    if (config_.pipelined) renderStates_ = new RenderStateBuffer(); 
+    sceneManager_->SetDeferDeletes(config_.pipelined); 
+
+    for (auto& budget : config_.memoryBudgets) 
+    {
+        // tags that do not exist yet are added, so the budget
+        // applies once something is allocated under them
+        MemoryTracker::SetBudget(MemoryTracker::RegisterTag(budget.first), budget.second); 
+    }
+
+    if (!config_.memoryBudgets.empty() && !MemoryTracker::IsEnabled()) 
+    {
+        Logger::Warning("Memory budgets set, but memory tracking is compiled out"); 
+    }
+
+    if (!config_.profileTrace.empty()) 
+    {
+#if OASIS_PROFILE 
+        Profiler::SetEnabled(true); 
+#else 
+        Logger::Warning("Profile trace requested, but zones are compiled out"); 
+#endif 
+    }
+
+    return GameLoop(); 
 }
 
 void Engine::Stop()
@@ -63,6 +141,8 @@ void Engine::Stop()
 
 int Engine::GameLoop() 
 {
+    OASIS_PROFILE_THREAD("Main"); 
+
     app_->Init(); 
 
     int tickCount = 0;
@@ -70,64 +150,95 @@ int Engine::GameLoop()
 
     float dt = 1.0 / config_.targetUps;
 
-    Timer timer;
     Timer secondTimer;
 
-    //double frameTimer = 0;
-    double skipFrames = 1.0 / config_.targetFps;
+    FramePacer pacer(config_.targetUps, config_.targetFps); 
+    pacer.SetMaxTicks(config_.maxTicksPerFrame); 
+    pacer.SetSpinTime(config_.spinSeconds); 
 
-    //double tickTimer = 0;
-    double skipTicks = 1.0 / config_.targetUps;
-
-    double prevTime = timer.GetSeconds(); 
-    double delay = 0; 
-
-    double prevFrameTime = timer.GetSeconds(); 
-    double frameDelay = 0; 
+    uint64 droppedTicks = 0; 
 
     while (running_) 
     {
-        double curTime = timer.GetSeconds(); 
-        double delta = curTime - prevTime; 
-        prevTime = curTime; 
-        delay += delta; 
-
-        double curFrameTime = timer.GetSeconds(); 
-        double frameDelta = curFrameTime - prevFrameTime; 
-        prevFrameTime = curFrameTime; 
-        frameDelay += frameDelta; 
+        // events are polled on this thread, ticks may run on another
+        if (display_) display_->PollEvents(); 
 
-        bool render = false; 
+        int ticks; 
+        bool render; 
 
-        while (delay >= skipTicks) 
+        if (config_.fixedStep) 
         {
+            // no pacing, the next tick starts as soon as this one is drawn
+            ticks = 1; 
             render = true; 
+        }
+        else 
+        {
+            ticks = pacer.TakeTicks(); 
 
-            PreUpdate(dt);
-            app_->Update(dt);
-            if (sceneManager_->GetActiveScene()) sceneManager_->GetActiveScene()->Update(dt); 
-            PostUpdate(dt);
-
-            delay -= skipTicks; 
-            tickCount++;
+            // without a display there is nothing to show until something changes
+            render = pacer.IsFrameDue() && (ticks > 0 || !IsHeadless()); 
         }
 
-        // TODO change this 
-        // while (render && frameDelay >= skipFrames) 
-        
+        if (renderStates_) 
+        {
+            // the ticks update on the job system while the state
+            // extracted after the previous ones is drawn
+            JobCounter counter; 
+            if (ticks) jobSystem_->Schedule([ticks, dt]() { SimulatePipelined(ticks, dt); }, &counter); 
+
+            if (render) RenderFrame(&renderStates_->GetReadState()); 
+
+            jobSystem_->Wait(counter); 
+
+            if (ticks) 
+            {
+                renderStates_->Swap(); 
+
+                // only the state just extracted is drawn from now on,
+                // and it does not refer to anything retired before
+                sceneManager_->DeleteRetired(); 
+            }
+        }
+        else 
         {
-            PreRender();
-            app_->Render();
-            if (sceneManager_->GetActiveScene()) sceneManager_->GetActiveScene()->Render(); 
-            PostRender();
+            for (int i = 0; i < ticks; i++) 
+            {
+                Tick(dt); 
+            }
+
+            if (render) RenderFrame(nullptr); 
+        }
+
+        // no jobs are running, so no thread is using its arena
+        FrameArena::ResetAll(); 
 
-            frameDelay -= skipFrames; 
-            frameCount++;
+        tickCount += ticks; 
+
+        if (render) 
+        {
+            pacer.FrameRendered(); 
+            frameTime_ = pacer.GetFrameTime(); 
+
+            if (pacer.GetLastFrameTime() > 0) 
+            {
+                telemetry_->AddFrame(pacer.GetLastFrameTime(), graphics_->GetDrawCount()); 
+            }
+            frameCount++; 
         }
 
         if (secondTimer.GetSeconds() >= 1)
         {
             Logger::Debug("FPS: ", frameCount, ", Ticks: ", tickCount); 
+
+            if (pacer.GetDroppedTicks() > droppedTicks) 
+            {
+                Logger::Warning("Engine fell behind, dropped ", pacer.GetDroppedTicks() - droppedTicks, " ticks"); 
+                droppedTicks = pacer.GetDroppedTicks(); 
+            }
+
+            MemoryTracker::CheckBudgets(); 
+
             fps_ = frameCount;
             ups_ = tickCount;
             tickCount = frameCount = 0;
@@ -135,10 +246,25 @@ int Engine::GameLoop()
             secondTimer.Reset();
         }
 
-        if (display_->IsCloseRequested())
+        if (display_ && display_->IsCloseRequested()) 
         {
             Engine::Stop();
         }
+
+        if (config_.tickLimit > 0 && totalTicks_ >= config_.tickLimit) 
+        {
+            Logger::Debug("Reached tick limit of ", config_.tickLimit); 
+            Engine::Stop(); 
+        }
+
+        // an uncapped frame rate with a display renders without waiting
+        bool wait = config_.targetFps > 0 || IsHeadless(); 
+        if (running_ && !config_.fixedStep && wait) pacer.Wait(); 
+    }
+
+    if (!config_.telemetryReport.empty()) 
+    {
+        telemetry_->WriteReport(config_.telemetryReport, sceneManager_); 
     }
 
     app_->Exit(); 
@@ -156,26 +282,116 @@ int Engine::GameLoop()
     delete sceneManager_; 
     sceneManager_ = nullptr; 
 
+    delete eventManager_; 
+    eventManager_ = nullptr; 
+
+    delete jobSystem_; 
+    jobSystem_ = nullptr; 
+
+    delete renderStates_; 
+    renderStates_ = nullptr; 
+
+    delete telemetry_; 
+    telemetry_ = nullptr; 
+
+    if (Profiler::IsEnabled() && !config_.profileTrace.empty()) 
+    {
+        Profiler::SetEnabled(false); 
+        Profiler::WriteChromeTrace(config_.profileTrace); 
+    }
+
     app_ = nullptr; 
 
     Logger::Debug("Engine terminated!");
 
+    if (config_.asyncLogging) Logger::SetAsync(false); 
+
     return 0; 
 }
 
+void Engine::Tick(float dt) 
+{
+    OASIS_PROFILE_ZONE("Engine::Tick"); 
+    uint64 start = Time::Nanos(); 
+
+    PreUpdate(dt); 
+    app_->Update(dt); 
+    Scene* active = sceneManager_->GetActiveScene(); 
+    if (active && !active->IsSimulated()) active->Update(dt); 
+    sceneManager_->Simulate(dt); 
+    PostUpdate(dt); 
+
+    totalTicks_++; 
+
+    uint64 entities = 0; 
+    for (uint32 i = 0; i < sceneManager_->GetSceneCount(); i++) 
+    {
+        // unloaded scenes leave an empty slot
+        Scene* scene = sceneManager_->GetSceneByIndex(i); 
+        if (scene) entities += scene->GetEntityManager().GetEntityCount(); 
+    }
+
+    telemetry_->SetEntityCount(entities); 
+    telemetry_->AddUpdate((Time::Nanos() - start) / 1e9); 
+}
+
+void Engine::SimulatePipelined(int ticks, float dt) 
+{
+    OASIS_PROFILE_ZONE("Engine::Simulate"); 
+
+    for (int i = 0; i < ticks; i++) 
+    {
+        Tick(dt); 
+    }
+
+    RenderState& state = renderStates_->GetWriteState(); 
+    Scene* active = sceneManager_->GetActiveScene(); 
+
+    if (active) active->Extract(state); 
+    else state.Clear(); 
+
+    state.SetTick(totalTicks_); 
+}
+
+void Engine::RenderFrame(const RenderState* state) 
+{
+    OASIS_PROFILE_ZONE("Engine::Render"); 
+    uint64 start = Time::Nanos(); 
+
+    PreRender(); 
+    app_->Render(); 
+
+    if (state) 
+    {
+        if (state->GetScene()) state->GetScene()->Draw(*state); 
+    }
+    else if (sceneManager_->GetActiveScene()) 
+    {
+        sceneManager_->GetActiveScene()->Render(); 
+    }
+
+    PostRender(); 
+
+    telemetry_->AddRender((Time::Nanos() - start) / 1e9); 
+}
+
 void Engine::PreUpdate(float dt) 
 {
     (void) dt; 
-    display_->PollEvents(); 
 }
 
 void Engine::PostUpdate(float dt) 
 {
     (void) dt; 
+
+    // events queued during the tick, systems are done by now
+    eventManager_->DispatchQueuedEvents(); 
 }
 
 void Engine::PreRender() 
 {
+    OASIS_PROFILE_ZONE("Engine::PreRender"); 
+
     graphics_->PreRender(); 
     graphics_->SetClearColor(0.6, 0.8, 0.9); 
     graphics_->Clear(); 
@@ -183,8 +399,15 @@ void Engine::PreRender()
 
 void Engine::PostRender() 
 {
+    OASIS_PROFILE_ZONE("Engine::PostRender"); 
+
     graphics_->PostRender(); 
-    display_->SwapBuffers(); 
+
+    if (display_) 
+    {
+        OASIS_PROFILE_ZONE("Display::SwapBuffers"); 
+        display_->SwapBuffers(); 
+    }
 }
 
 }
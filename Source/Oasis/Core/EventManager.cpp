@@ -5,50 +5,180 @@
 namespace Oasis 
 {
 
+EventManager::EventManager() 
+{
+    for (auto& queue : queues_) 
+    {
+        queue.store(nullptr, std::memory_order_relaxed); 
+    }
+}
+
+EventManager::~EventManager() 
+{
+    for (auto& queue : queues_) 
+    {
+        delete queue.load(); 
+    }
+
+    for (auto& list : callbacks_) 
+    {
+        for (auto callback : list) 
+        {
+            delete callback; 
+        }
+    }
+
+    for (auto& pending : pendingAdds_) 
+    {
+        delete pending.second; 
+    }
+}
+
 void EventManager::Subscribe(ClassId eventId, EventCallbackBase* callback) 
 {
+    if (delivering_) 
+    {
+        pendingAdds_.push_back({ eventId, callback }); 
+        return; 
+    }
+
+    if (eventId >= callbacks_.size()) callbacks_.resize(eventId + 1); 
+
     auto& list = callbacks_[eventId]; 
 
-    list.push_back(callback); 
+    // after callbacks of the same priority, so they keep subscription order
+    auto at = std::upper_bound(list.begin(), list.end(), callback, [](EventCallbackBase* a, EventCallbackBase* b) -> bool 
+    {
+        return a->priority < b->priority; 
+    }); 
 
-    std::sort(list.begin(), list.end(), [&](EventCallbackBase* a, EventCallbackBase* b) -> bool { return a->priority - b->priority; });
+    list.insert(at, callback); 
 }
 
 bool EventManager::Unsubscribe(ClassId eventId, EventCallbackBase* remove) 
 {
-    auto it = callbacks_.find(eventId); 
-
-    if (it != callbacks_.end()) 
+    if (eventId < callbacks_.size()) 
     {
-        auto& list = it->second; 
+        auto& list = callbacks_[eventId]; 
 
-        for (auto iter = list.begin(); iter != list.end(); ++iter)  
+        for (auto iter = list.begin(); iter != list.end(); ++iter) 
         {
-            if ((*iter)->Equals(remove)) 
+            if (*iter && (*iter)->Equals(remove)) 
             {
-                list.erase(iter); 
+                if (delivering_) 
+                {
+                    // removed from the list once delivery is done
+                    pendingDeletes_.push_back(*iter); 
+                    *iter = nullptr; 
+                }
+                else 
+                {
+                    delete *iter; 
+                    list.erase(iter); 
+                }
+
                 return true; 
             }
         }
     }
 
+    for (auto iter = pendingAdds_.begin(); iter != pendingAdds_.end(); ++iter) 
+    {
+        if (iter->first == eventId && iter->second->Equals(remove)) 
+        {
+            delete iter->second; 
+            pendingAdds_.erase(iter); 
+            return true; 
+        }
+    }
+
     return false; 
 }
 
-
 void EventManager::SendEvent(ClassId eventId, Event* event) 
 {
-    auto it = callbacks_.find(eventId); 
+    if (eventId < callbacks_.size()) 
+    {
+        BeginDelivery(); 
 
-    if (it != callbacks_.end()) 
+        for (auto callback : callbacks_[eventId]) 
+        {
+            if (callback) callback->Invoke(event); 
+        }
+
+        EndDelivery(); 
+    }
+}
+
+void EventManager::DispatchQueuedEvents() 
+{
+    static const std::vector<EventCallbackBase*> none; 
+
+    BeginDelivery(); 
+
+    for (ClassId id = 0; id < OASIS_MAX_EVENT_TYPES; id++) 
     {
-        auto& list = it->second; 
+        EventQueueBase* queue = queues_[id].load(std::memory_order_acquire); 
 
-        for (auto callback : list) 
+        if (queue) queue->Dispatch(id < callbacks_.size() ? callbacks_[id] : none); 
+    }
+
+    EndDelivery(); 
+}
+
+EventQueueBase* EventManager::AddQueue(ClassId eventId, EventQueueBase* queue) 
+{
+    if (eventId >= OASIS_MAX_EVENT_TYPES) 
+    {
+        Logger::Fatal("EventManager: More than ", OASIS_MAX_EVENT_TYPES, " event types, increase OASIS_MAX_EVENT_TYPES"); 
+        std::abort(); 
+    }
+
+    std::lock_guard<std::mutex> lock(queueMutex_); 
+
+    EventQueueBase* existing = queues_[eventId].load(std::memory_order_acquire); 
+
+    if (existing) 
+    {
+        delete queue; 
+        return existing; 
+    }
+
+    queues_[eventId].store(queue, std::memory_order_release); 
+
+    return queue; 
+}
+
+void EventManager::BeginDelivery() 
+{
+    delivering_++; 
+}
+
+void EventManager::EndDelivery() 
+{
+    if (--delivering_) return; 
+
+    if (!pendingDeletes_.empty()) 
+    {
+        for (auto& list : callbacks_) 
         {
-            callback->Invoke(event); 
+            list.erase(std::remove(list.begin(), list.end(), nullptr), list.end()); 
         }
+
+        for (auto callback : pendingDeletes_) 
+        {
+            delete callback; 
+        }
+        pendingDeletes_.clear(); 
+    }
+
+    std::vector<std::pair<ClassId, EventCallbackBase*>> adds; 
+    adds.swap(pendingAdds_); 
+
+    for (auto& add : adds) 
+    {
+        Subscribe(add.first, add.second); 
     }
 }
 
-}
\ No newline at end of file
+}
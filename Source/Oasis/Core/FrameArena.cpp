@@ -0,0 +1,172 @@
+#include "Oasis/Core/FrameArena.h"
+
+#include "Oasis/Core/MemoryTracker.h"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+namespace Oasis
+{
+
+const size_t FrameArena::DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+namespace
+{
+    std::mutex registryMutex;
+    std::vector<FrameArena*> threadArenas;
+
+    // frees the thread's arena when the thread exits
+    struct ThreadArena
+    {
+        FrameArena* arena = nullptr;
+
+        ~ThreadArena()
+        {
+            if (!arena) return;
+
+            std::lock_guard<std::mutex> lock(registryMutex);
+            threadArenas.erase(std::find(threadArenas.begin(), threadArenas.end(), arena));
+            delete arena;
+        }
+    };
+
+    thread_local ThreadArena threadArena;
+
+    char* AllocateBlock(size_t size)
+    {
+        char* data = static_cast<char*>(std::malloc(size));
+        if (!data) throw std::bad_alloc();
+
+        MemoryTracker::Allocated(MemoryTracker::FRAME_ARENA, size);
+        return data;
+    }
+}
+
+FrameArena::FrameArena() {}
+
+FrameArena::~FrameArena()
+{
+    FreeBlocks();
+}
+
+FrameArena& FrameArena::GetThreadArena()
+{
+    if (!threadArena.arena)
+    {
+        threadArena.arena = new FrameArena();
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threadArenas.push_back(threadArena.arena);
+    }
+
+    return *threadArena.arena;
+}
+
+void FrameArena::ResetAll()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    for (auto arena : threadArenas)
+    {
+        arena->Reset();
+    }
+}
+
+void* FrameArena::Allocate(size_t size, size_t align)
+{
+    while (true)
+    {
+        if (block_ == blocks_.size())
+        {
+            size_t last = blocks_.empty() ? DEFAULT_BLOCK_SIZE / 2 : blocks_.back().size;
+            size_t blockSize = std::max(last * 2, size + align);
+
+            blocks_.push_back({ AllocateBlock(blockSize), blockSize });
+        }
+
+        Block& block = blocks_[block_];
+
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+        size_t start = ((base + offset_ + align - 1) & ~static_cast<uintptr_t>(align - 1)) - base;
+
+        if (start + size <= block.size)
+        {
+            offset_ = start + size;
+            return block.data + start;
+        }
+
+        // the rest of the block stays unused until the next reset
+        block_++;
+        offset_ = 0;
+    }
+}
+
+void FrameArena::Reset()
+{
+    size_t used = GetUsed();
+    if (used > highWater_) highWater_ = used;
+
+    if (blocks_.size() > 1)
+    {
+        // one block that fits everything the frame needed
+        size_t capacity = GetCapacity();
+
+        FreeBlocks();
+        blocks_.push_back({ AllocateBlock(capacity), capacity });
+    }
+
+    block_ = 0;
+    offset_ = 0;
+}
+
+FrameArena::Marker FrameArena::GetMarker() const
+{
+    return { block_, offset_ };
+}
+
+void FrameArena::Rewind(const Marker& marker)
+{
+    size_t used = GetUsed();
+    if (used > highWater_) highWater_ = used;
+
+    block_ = marker.block;
+    offset_ = marker.offset;
+}
+
+size_t FrameArena::GetUsed() const
+{
+    size_t used = offset_;
+
+    for (uint32 i = 0; i < block_ && i < blocks_.size(); i++)
+    {
+        used += blocks_[i].size;
+    }
+
+    return used;
+}
+
+size_t FrameArena::GetCapacity() const
+{
+    size_t capacity = 0;
+
+    for (auto& block : blocks_)
+    {
+        capacity += block.size;
+    }
+
+    return capacity;
+}
+
+void FrameArena::FreeBlocks()
+{
+    for (auto& block : blocks_)
+    {
+        std::free(block.data);
+        MemoryTracker::Freed(MemoryTracker::FRAME_ARENA, block.size);
+    }
+
+    blocks_.clear();
+}
+
+}
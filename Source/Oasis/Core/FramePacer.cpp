@@ -0,0 +1,99 @@
+#include "Oasis/Core/FramePacer.h"
+
+#include "Oasis/Core/TimeUtil.h"
+
+#include <thread>
+
+namespace Oasis
+{
+
+FramePacer::FramePacer(double targetUps, double targetFps)
+    : start_(Time::Nanos())
+    , tickInterval_(1.0 / targetUps)
+    , frameInterval_(targetFps > 0 ? 1.0 / targetFps : 0)
+    , nextTick_(tickInterval_)
+    , nextFrame_(0) {}
+
+double FramePacer::GetTime() const
+{
+    return (Time::Nanos() - start_) / 1e9;
+}
+
+int FramePacer::TakeTicks()
+{
+    double now = GetTime();
+    int ticks = 0;
+
+    while (now >= nextTick_ && ticks < maxTicks_)
+    {
+        nextTick_ += tickInterval_;
+        ticks++;
+    }
+
+    if (now >= nextTick_)
+    {
+        // behind by more than the max ticks, skip to the present
+        uint64 dropped = static_cast<uint64>((now - nextTick_) / tickInterval_) + 1;
+        nextTick_ += dropped * tickInterval_;
+        droppedTicks_ += dropped;
+    }
+
+    return ticks;
+}
+
+bool FramePacer::IsFrameDue() const
+{
+    return frameInterval_ <= 0 || GetTime() >= nextFrame_;
+}
+
+void FramePacer::FrameRendered()
+{
+    double now = GetTime();
+
+    if (lastFrame_ >= 0)
+    {
+        double frameTime = now - lastFrame_;
+        lastFrameTime_ = frameTime;
+
+        if (frameTime_ == 0) frameTime_ = frameTime;
+        else frameTime_ += (frameTime - frameTime_) * smoothing_;
+    }
+    lastFrame_ = now;
+
+    if (frameInterval_ > 0)
+    {
+        nextFrame_ += frameInterval_;
+
+        // more than a whole frame late, start a new cadence from now
+        if (nextFrame_ <= now) nextFrame_ = now + frameInterval_;
+    }
+}
+
+void FramePacer::Wait()
+{
+    double next = nextTick_;
+    if (frameInterval_ > 0 && nextFrame_ < next) next = nextFrame_;
+
+    WaitUntil(next);
+}
+
+void FramePacer::WaitUntil(double time)
+{
+    while (true)
+    {
+        double remaining = time - GetTime();
+
+        if (remaining <= 0) break;
+
+        if (remaining > spinTime_)
+        {
+            Time::SleepNanos(static_cast<uint64>((remaining - spinTime_) * 1e9));
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+}
@@ -0,0 +1,271 @@
+#include "Oasis/Core/JobSystem.h" 
+
+#include "Oasis/Core/Profiler.h" 
+
+namespace Oasis 
+{
+
+namespace 
+{
+    struct ThreadQueue 
+    {
+        const JobSystem* system; 
+        uint32 queue; 
+    };
+
+    // queue of the worker running on this thread
+    thread_local ThreadQueue threadQueue = { nullptr, 0 }; 
+
+    const uint32 CACHE_LINE_SIZE = 64; 
+
+    // ranges per thread, more balances uneven work better
+    const uint32 RANGES_PER_THREAD = 4; 
+}
+
+uint32 JobSystem::GetDefaultWorkerCount() 
+{
+    uint32 threads = std::thread::hardware_concurrency(); 
+
+    return threads > 1 ? threads - 1 : 0; 
+}
+
+JobSystem::JobSystem() 
+    : queued_(0), sleeping_(0), stopping_(false) 
+{
+    StartWorkers(GetDefaultWorkerCount()); 
+}
+
+JobSystem::JobSystem(uint32 workerCount) 
+    : queued_(0), sleeping_(0), stopping_(false) 
+{
+    StartWorkers(workerCount); 
+}
+
+JobSystem::~JobSystem() 
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_); 
+        stopping_ = true; 
+    }
+    wake_.notify_all(); 
+
+    for (auto& worker : workers_) 
+    {
+        worker.join(); 
+    }
+
+    // jobs nobody waited on still run so their counters are released
+    while (RunJob(0)) {} 
+
+    for (auto queue : queues_) 
+    {
+        delete queue; 
+    }
+}
+
+void JobSystem::StartWorkers(uint32 workerCount) 
+{
+    // queue 0 is shared by threads that are not workers
+    for (uint32 i = 0; i <= workerCount; i++) 
+    {
+        queues_.push_back(new WorkQueue()); 
+    }
+
+    for (uint32 i = 0; i < workerCount; i++) 
+    {
+        workers_.push_back(std::thread(&JobSystem::WorkerLoop, this, i + 1)); 
+    }
+
+    Logger::Debug("JobSystem: Started ", workerCount, " worker threads"); 
+}
+
+uint32 JobSystem::GetThreadQueue() const 
+{
+    return threadQueue.system == this ? threadQueue.queue : 0; 
+}
+
+void JobSystem::Schedule(const Job& job, JobCounter* counter) 
+{
+    if (counter) counter->count_++; 
+
+    Push({ job, counter }); 
+}
+
+void JobSystem::Schedule(const Job& job, JobCounter* counter, JobCounter& dependency) 
+{
+    if (counter) counter->count_++; 
+
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex_); 
+
+        if (!dependency.IsDone()) 
+        {
+            // pushed by the job that finishes the dependency
+            dependency.dependents_.push_back({ this, job, counter }); 
+            return; 
+        }
+    }
+
+    Push({ job, counter }); 
+}
+
+void JobSystem::Push(QueuedJob job) 
+{
+    WorkQueue* queue = queues_[GetThreadQueue()]; 
+
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex); 
+        queue->jobs.push_back(std::move(job)); 
+    }
+
+    queued_++; 
+
+    // a worker counts itself as sleeping before it checks queued_,
+    // so one of the two always sees the other
+    if (sleeping_.load()) 
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_); 
+        wake_.notify_one(); 
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter) 
+{
+    uint32 queue = GetThreadQueue(); 
+
+    while (!counter.IsDone()) 
+    {
+        if (!RunJob(queue)) 
+        {
+            // the remaining jobs are running on other threads
+            std::this_thread::yield(); 
+        }
+    }
+}
+
+void JobSystem::WorkerLoop(uint32 queue) 
+{
+    threadQueue.system = this; 
+    threadQueue.queue = queue; 
+
+    OASIS_PROFILE_THREAD("Worker " + std::to_string(queue)); 
+
+    while (true) 
+    {
+        if (RunJob(queue)) continue; 
+
+        std::unique_lock<std::mutex> lock(sleepMutex_); 
+
+        sleeping_++; 
+        wake_.wait(lock, [this]() { return stopping_.load() || queued_.load() > 0; }); 
+        sleeping_--; 
+
+        if (stopping_ && !queued_) return; 
+    }
+}
+
+bool JobSystem::RunJob(uint32 queue) 
+{
+    QueuedJob job; 
+    bool found = false; 
+
+    // newest job of our own queue first, it is likely still in cache
+    {
+        WorkQueue* own = queues_[queue]; 
+        std::lock_guard<std::mutex> lock(own->mutex); 
+
+        if (!own->jobs.empty()) 
+        {
+            job = std::move(own->jobs.back()); 
+            own->jobs.pop_back(); 
+            found = true; 
+        }
+    }
+
+    // then steal the oldest job of another queue, which
+    // is usually the largest piece of work left
+    for (uint32 i = 1; !found && i < queues_.size(); i++) 
+    {
+        WorkQueue* other = queues_[(queue + i) % queues_.size()]; 
+        std::lock_guard<std::mutex> lock(other->mutex); 
+
+        if (!other->jobs.empty()) 
+        {
+            job = std::move(other->jobs.front()); 
+            other->jobs.pop_front(); 
+            found = true; 
+        }
+    }
+
+    if (!found) return false; 
+
+    queued_--; 
+
+    job.job(); 
+    Finish(job.counter); 
+
+    return true; 
+}
+
+void JobSystem::Finish(JobCounter* counter) 
+{
+    if (!counter) return; 
+
+    std::vector<JobCounter::Dependent> dependents; 
+
+    {
+        // held so a dependent cannot be added after the check
+        std::lock_guard<std::mutex> lock(counter->mutex_); 
+
+        if (--counter->count_ == 0) 
+        {
+            dependents.swap(counter->dependents_); 
+        }
+    }
+
+    for (auto& dependent : dependents) 
+    {
+        dependent.system->Push({ dependent.job, dependent.counter }); 
+    }
+}
+
+uint32 JobSystem::GetGrainSize(uint32 count, uint32 itemSize) const 
+{
+    uint32 perLine = itemSize && itemSize < CACHE_LINE_SIZE ? CACHE_LINE_SIZE / itemSize : 1; 
+    uint32 ranges = (GetWorkerCount() + 1) * RANGES_PER_THREAD; 
+    uint32 grain = (count + ranges - 1) / ranges; 
+
+    // whole cache lines so two ranges never write the same line
+    grain = (grain + perLine - 1) / perLine * perLine; 
+
+    return grain ? grain : perLine; 
+}
+
+void JobSystem::ParallelFor(uint32 count, const RangeJob& fn, uint32 grainSize) 
+{
+    if (!count) return; 
+
+    if (!grainSize) grainSize = GetGrainSize(count); 
+
+    if (count <= grainSize || workers_.empty()) 
+    {
+        fn(0, count); 
+        return; 
+    }
+
+    JobCounter counter; 
+
+    // the first range is run by this thread
+    for (uint32 begin = grainSize; begin < count; begin += grainSize) 
+    {
+        uint32 end = count - begin > grainSize ? begin + grainSize : count; 
+
+        Schedule([&fn, begin, end]() { fn(begin, end); }, &counter); 
+    }
+
+    fn(0, grainSize); 
+
+    Wait(counter); 
+}
+
+}
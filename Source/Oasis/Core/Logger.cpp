@@ -1,20 +1,382 @@
 #include "Oasis/Core/Logger.h" 
 
+#include <chrono> 
 #include <iostream> 
+#include <mutex> 
+#include <thread> 
 
 using namespace std; 
 
 namespace Oasis 
 {
 
+namespace 
+{
+    // ring buffer of one thread, records never wrap around its end 
+    const uint32 RING_SIZE = 1 << 17; 
+    const uint32 MAX_RECORD_SIZE = 1 << 12; 
+
+    struct RecordHeader 
+    { 
+        // 0 marks the rest of the ring as unused 
+        uint32 size; 
+        uint32 level; 
+        uint64 sequence; 
+    }; 
+
+    struct ThreadLog 
+    { 
+        char data[RING_SIZE]; 
+
+        // bytes ever written and read 
+        std::atomic<uint64> head; 
+        std::atomic<uint64> tail; 
+    }; 
+
+    class FixedStreamBuf : public std::streambuf 
+    { 
+    public: 
+        inline void Reset(char* begin, char* end) { setp(begin, end); } 
+        inline uint32 GetSize() const { return pptr() - pbase(); } 
+    }; 
+
+    // buffers are never freed, a thread may log again after async 
+    // logging was stopped and started again 
+    std::mutex registryMutex; 
+    std::vector<ThreadLog*> threadLogs; 
+
+    // sequences are taken when a record is begun, the writer only
+    // writes the next one once it is published, guarded by outputMutex 
+    std::atomic<uint64> nextSequence(0); 
+    uint64 nextWrite = 0; 
+
+    std::mutex outputMutex; 
+    std::thread writerThread; 
+    std::atomic<bool> writerRunning(false); 
+
+    thread_local ThreadLog* threadLog = nullptr; 
+    thread_local uint64 recordStart = 0; 
+    thread_local uint64 recordSequence = 0; 
+
+    // formats arguments that are not stored as they are 
+    thread_local FixedStreamBuf formatBuffer; 
+    thread_local std::ostream formatStream(&formatBuffer); 
+
+    inline uint32 Align(uint32 size) 
+    { 
+        return (size + 7) & ~7u; 
+    } 
+
+    ThreadLog* GetThreadLog() 
+    { 
+        if (!threadLog) 
+        { 
+            ThreadLog* log = new ThreadLog(); 
+            log->head = 0; 
+            log->tail = 0; 
+
+            std::lock_guard<std::mutex> lock(registryMutex); 
+            threadLogs.push_back(log); 
+
+            threadLog = log; 
+        } 
+
+        return threadLog; 
+    } 
+
+    // first record of the log that has not been read, or null 
+    const RecordHeader* PeekRecord(ThreadLog* log) 
+    { 
+        uint64 head = log->head.load(std::memory_order_acquire); 
+        uint64 tail = log->tail.load(std::memory_order_relaxed); 
+
+        if (tail == head) return nullptr; 
+
+        const RecordHeader* header = reinterpret_cast<const RecordHeader*>(log->data + tail % RING_SIZE); 
+
+        if (header->size == 0) 
+        { 
+            // skip the unused end of the ring 
+            tail += RING_SIZE - tail % RING_SIZE; 
+            log->tail.store(tail, std::memory_order_release); 
+
+            if (tail == head) return nullptr; 
+            header = reinterpret_cast<const RecordHeader*>(log->data); 
+        } 
+
+        return header; 
+    } 
+
+    template <class T> 
+    T Read(const char*& pos) 
+    { 
+        T value; 
+        std::memcpy(&value, pos, sizeof (T)); 
+        pos += sizeof (T); 
+        return value; 
+    } 
+
+    void FormatRecord(std::ostream& out, const RecordHeader* header) 
+    { 
+        const char* pos = reinterpret_cast<const char*>(header + 1); 
+        const char* end = reinterpret_cast<const char*>(header) + header->size; 
+
+        out << GetLogLevelName(static_cast<LogLevel>(header->level)); 
+
+        while (pos < end) 
+        { 
+            uint8 tag = Read<uint8>(pos); 
+
+            switch (tag) 
+            { 
+            case LogRecordWriter::INT: out << Read<int64>(pos); break; 
+            case LogRecordWriter::UINT: out << Read<uint64>(pos); break; 
+            case LogRecordWriter::DOUBLE: out << Read<double>(pos); break; 
+            case LogRecordWriter::BOOL: out << Read<bool>(pos); break; 
+            case LogRecordWriter::CHAR: out << Read<char>(pos); break; 
+            case LogRecordWriter::POINTER: out << Read<const void*>(pos); break; 
+            case LogRecordWriter::STRING: 
+            { 
+                uint32 size = Read<uint32>(pos); 
+                out.write(pos, size); 
+                pos += size; 
+                break; 
+            } 
+            default: 
+                // padding at the end of the record 
+                pos = end; 
+                break; 
+            } 
+        } 
+
+        out << '\n'; 
+    } 
+
+    // formats the records that were logged, in the order they were logged 
+    // across threads, up to the first one that is still being written, 
+    // and returns how many there were 
+    uint32 WriteRecords(std::ostream* out) 
+    { 
+        std::vector<ThreadLog*> logs; 
+        { 
+            std::lock_guard<std::mutex> lock(registryMutex); 
+            logs = threadLogs; 
+        } 
+
+        uint32 count = 0; 
+
+        while (true) 
+        { 
+            ThreadLog* next = nullptr; 
+            const RecordHeader* nextHeader = nullptr; 
+
+            for (auto log : logs) 
+            { 
+                const RecordHeader* header = PeekRecord(log); 
+
+                if (header && (!nextHeader || header->sequence < nextHeader->sequence)) 
+                { 
+                    next = log; 
+                    nextHeader = header; 
+                } 
+            } 
+
+            // an earlier record is still being written by another thread 
+            if (!next || nextHeader->sequence != nextWrite) break; 
+
+            if (out) FormatRecord(*out, nextHeader); 
+            next->tail.fetch_add(nextHeader->size, std::memory_order_release); 
+            nextWrite++; 
+            count++; 
+        } 
+
+        if (count && out) out->flush(); 
+
+        return count; 
+    } 
+
+    void WriterLoop() 
+    { 
+        while (writerRunning.load(std::memory_order_acquire)) 
+        { 
+            uint32 count; 
+            { 
+                std::lock_guard<std::mutex> lock(outputMutex); 
+                count = WriteRecords(Logger::GetOutput()); 
+            } 
+
+            if (!count) std::this_thread::sleep_for(std::chrono::milliseconds(1)); 
+        } 
+    } 
+
+    // stops the writer if the program exits without doing so 
+    struct WriterGuard 
+    { 
+        ~WriterGuard() { Logger::SetAsync(false); } 
+    } writerGuard; 
+}
+
 ostream* Logger::out_ = &cout; 
 LogLevel Logger::level_ = LogLevel::DEBUG; 
+std::atomic<bool> Logger::async_(false); 
+
+void Logger::SetOutput(ostream* out) 
+{
+    std::lock_guard<std::mutex> lock(outputMutex); 
+    out_ = out; 
+}
 
 void Logger::SetLevel(LogLevel level) 
 {
-    if (level_ == LogLevel::count) level_ = LogLevel::FINE; 
+    if (level == LogLevel::count) level = LogLevel::FINE; 
 
     level_ = level; 
 }
 
-}
\ No newline at end of file
+void Logger::SetAsync(bool async) 
+{
+    if (async == async_) return; 
+
+    if (async) 
+    { 
+        async_ = true; 
+        writerRunning = true; 
+        writerThread = std::thread(WriterLoop); 
+    } 
+    else 
+    { 
+        writerRunning = false; 
+        writerThread.join(); 
+
+        // messages logged after the writer last looked 
+        std::lock_guard<std::mutex> lock(outputMutex); 
+        WriteRecords(out_); 
+        async_ = false; 
+    } 
+}
+
+void Logger::Flush() 
+{
+    if (async_) 
+    { 
+        uint64 end = nextSequence.load(); 
+
+        // records begun before the call may still be being written 
+        while (true) 
+        { 
+            { 
+                std::lock_guard<std::mutex> lock(outputMutex); 
+                WriteRecords(out_); 
+                if (nextWrite >= end) break; 
+            } 
+
+            std::this_thread::yield(); 
+        } 
+    } 
+    else 
+    { 
+        std::lock_guard<std::mutex> lock(outputMutex); 
+        if (out_) out_->flush(); 
+    } 
+}
+
+void Logger::WriteSync(LogLevel level, const std::string& message) 
+{
+    std::lock_guard<std::mutex> lock(outputMutex); 
+    if (out_) (*out_) << GetLogLevelName(level) << message << std::endl; 
+}
+
+LogRecordWriter Logger::BeginRecord() 
+{
+    ThreadLog* log = GetThreadLog(); 
+
+    uint64 head = log->head.load(std::memory_order_relaxed); 
+    uint32 offset = head % RING_SIZE; 
+
+    // records are contiguous, skip the end of the ring if one may not fit 
+    uint32 skip = RING_SIZE - offset < MAX_RECORD_SIZE ? RING_SIZE - offset : 0; 
+
+    while (head + skip + MAX_RECORD_SIZE - log->tail.load(std::memory_order_acquire) > RING_SIZE) 
+    { 
+        std::this_thread::yield(); 
+    } 
+
+    if (skip) 
+    { 
+        reinterpret_cast<RecordHeader*>(log->data + offset)->size = 0; 
+        offset = 0; 
+    } 
+
+    recordStart = head + skip; 
+
+    // taken once there is room, so no thread waits while holding a 
+    // sequence the writer needs 
+    recordSequence = nextSequence.fetch_add(1, std::memory_order_relaxed); 
+
+    char* begin = log->data + offset; 
+    return LogRecordWriter(begin + sizeof (RecordHeader), begin + MAX_RECORD_SIZE); 
+}
+
+void Logger::EndRecord(LogLevel level, const LogRecordWriter& writer) 
+{
+    ThreadLog* log = threadLog; 
+
+    char* begin = log->data + recordStart % RING_SIZE; 
+    uint32 size = Align(writer.GetPosition() - begin); 
+
+    // padding is read as an unknown tag 
+    std::memset(writer.GetPosition(), 0xFF, size - (writer.GetPosition() - begin)); 
+
+    RecordHeader* header = reinterpret_cast<RecordHeader*>(begin); 
+    header->size = size; 
+    header->level = static_cast<uint32>(level); 
+    header->sequence = recordSequence; 
+
+    log->head.store(recordStart + size, std::memory_order_release); 
+
+    if (level == LogLevel::FATAL) Flush(); 
+}
+
+void LogRecordWriter::Put(Tag tag, const void* data, uint32 size) 
+{
+    if (static_cast<uint32>(end_ - pos_) < 1 + size) return; 
+
+    *pos_++ = tag; 
+    std::memcpy(pos_, data, size); 
+    pos_ += size; 
+}
+
+void LogRecordWriter::WriteString(const char* data, size_t size) 
+{
+    if (end_ - pos_ < 5) return; 
+
+    // cut to what fits 
+    if (size > static_cast<size_t>(end_ - pos_ - 5)) size = end_ - pos_ - 5; 
+
+    std::memcpy(pos_ + 5, data, size); 
+    WriteStringHeader(size); 
+}
+
+void LogRecordWriter::WriteStringHeader(uint32 size) 
+{
+    uint32 length = size; 
+
+    *pos_ = STRING; 
+    std::memcpy(pos_ + 1, &length, sizeof (length)); 
+    pos_ += 5 + size; 
+}
+
+std::ostream& LogRecordWriter::BeginFormat(char* begin, char* end) 
+{
+    formatBuffer.Reset(begin, end); 
+    formatStream.clear(); 
+
+    return formatStream; 
+}
+
+uint32 LogRecordWriter::EndFormat() 
+{
+    return formatBuffer.GetSize(); 
+}
+
+}
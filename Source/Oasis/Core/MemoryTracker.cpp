@@ -0,0 +1,321 @@
+#include "Oasis/Core/MemoryTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+// set by the OASIS_TRACK_MEMORY CMake option
+#ifndef OASIS_TRACK_MEMORY
+    #define OASIS_TRACK_MEMORY 0
+#endif
+
+namespace Oasis
+{
+
+namespace
+{
+    struct TagCounters
+    {
+        std::atomic<int64> bytes;
+        std::atomic<int64> highWater;
+        std::atomic<int64> live;
+        std::atomic<uint64> allocations;
+
+        // only used while holding the registry lock
+        uint64 budget;
+        bool overBudget;
+
+        // set before the tag is counted in tagCount, the parent may
+        // be set later if nothing was counted under the tag yet
+        std::atomic<uint32> parent;
+        std::string name;
+    };
+
+    struct MemoryRegistry
+    {
+        std::mutex mutex;
+        TagCounters tags[MemoryTracker::MAX_TAGS];
+        std::atomic<uint32> tagCount;
+
+        MemoryRegistry()
+        {
+            for (auto& tag : tags)
+            {
+                tag.bytes = tag.highWater = tag.live = 0;
+                tag.allocations = 0;
+                tag.budget = 0;
+                tag.overBudget = false;
+                tag.parent = MemoryTracker::NO_TAG;
+            }
+
+            const char* names[] =
+            {
+                "Other", "Components", "Archetypes", "Meshes",
+                "Buffers", "Textures", "Shaders", "Frame arena",
+            };
+
+            static_assert(sizeof (names) / sizeof (names[0]) == MemoryTracker::BUILTIN_TAG_COUNT, "Every built-in tag needs a name");
+
+            for (uint32 i = 0; i < MemoryTracker::BUILTIN_TAG_COUNT; i++)
+            {
+                tags[i].name = names[i];
+            }
+
+            tags[MemoryTracker::ARCHETYPES].parent = MemoryTracker::COMPONENTS;
+
+            tagCount = MemoryTracker::BUILTIN_TAG_COUNT;
+        }
+    };
+
+    // constructed on first use and never destroyed, memory can be
+    // allocated during static initialization and freed after exit
+    MemoryRegistry& GetRegistry()
+    {
+        static MemoryRegistry* registry = new MemoryRegistry();
+        return *registry;
+    }
+
+    void RaiseHighWater(std::atomic<int64>& highWater, int64 bytes)
+    {
+        int64 current = highWater.load(std::memory_order_relaxed);
+
+        while (bytes > current && !highWater.compare_exchange_weak(current, bytes, std::memory_order_relaxed)) {}
+    }
+
+    // whether tag is parent or one of its parents
+    bool IsAncestor(const MemoryRegistry& registry, uint32 tag, uint32 parent)
+    {
+        while (parent != MemoryTracker::NO_TAG)
+        {
+            if (parent == tag) return true;
+            parent = registry.tags[parent].parent;
+        }
+
+        return false;
+    }
+
+    MemoryStats GetTagStats(const TagCounters& tag)
+    {
+        MemoryStats stats;
+
+        // counters are read one by one, a free seen before its
+        // allocation must not show up as a huge unsigned number
+        stats.bytes = std::max<int64>(0, tag.bytes.load(std::memory_order_relaxed));
+        stats.highWater = std::max<int64>(0, tag.highWater.load(std::memory_order_relaxed));
+        stats.liveAllocations = std::max<int64>(0, tag.live.load(std::memory_order_relaxed));
+        stats.allocations = tag.allocations.load(std::memory_order_relaxed);
+        stats.budget = tag.budget;
+
+        return stats;
+    }
+}
+
+uint32 MemoryTracker::RegisterTag(const std::string& name, uint32 parent)
+{
+    MemoryRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    uint32 count = registry.tagCount.load(std::memory_order_relaxed);
+    if (parent >= count) parent = NO_TAG;
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        TagCounters& tag = registry.tags[i];
+
+        if (tag.name == name)
+        {
+            // added by name before, such as to set its budget
+            if (tag.parent == NO_TAG && tag.allocations == 0 && !IsAncestor(registry, i, parent))
+            {
+                tag.parent = parent;
+            }
+
+            return i;
+        }
+    }
+
+    if (count == MAX_TAGS)
+    {
+        Logger::Warning("MemoryTracker: Out of tags, counting ", name, " as ", registry.tags[OTHER].name);
+        return OTHER;
+    }
+
+    registry.tags[count].name = name;
+    registry.tags[count].parent = parent;
+    registry.tagCount.store(count + 1, std::memory_order_release);
+
+    return count;
+}
+
+uint32 MemoryTracker::FindTag(const std::string& name)
+{
+    MemoryRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    uint32 count = registry.tagCount.load(std::memory_order_relaxed);
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        if (registry.tags[i].name == name) return i;
+    }
+
+    return NO_TAG;
+}
+
+uint32 MemoryTracker::GetTagCount()
+{
+    return GetRegistry().tagCount.load(std::memory_order_acquire);
+}
+
+std::string MemoryTracker::GetTagName(uint32 tag)
+{
+    MemoryRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    return tag < registry.tagCount ? registry.tags[tag].name : "";
+}
+
+uint32 MemoryTracker::GetParent(uint32 tag)
+{
+    MemoryRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    return tag < registry.tagCount ? registry.tags[tag].parent.load() : NO_TAG;
+}
+
+bool MemoryTracker::IsEnabled()
+{
+    return OASIS_TRACK_MEMORY != 0;
+}
+
+void MemoryTracker::Allocated(uint32 tag, size_t bytes)
+{
+#if OASIS_TRACK_MEMORY
+    Count(tag, static_cast<int64>(bytes), 1);
+#else
+    (void) tag;
+    (void) bytes;
+#endif
+}
+
+void MemoryTracker::Freed(uint32 tag, size_t bytes)
+{
+#if OASIS_TRACK_MEMORY
+    Count(tag, -static_cast<int64>(bytes), -1);
+#else
+    (void) tag;
+    (void) bytes;
+#endif
+}
+
+void MemoryTracker::Count(uint32 tag, int64 bytes, int64 allocations)
+{
+    MemoryRegistry& registry = GetRegistry();
+
+    while (tag < MAX_TAGS)
+    {
+        TagCounters& counters = registry.tags[tag];
+
+        int64 now = counters.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        counters.live.fetch_add(allocations, std::memory_order_relaxed);
+
+        if (allocations > 0)
+        {
+            counters.allocations.fetch_add(1, std::memory_order_relaxed);
+            RaiseHighWater(counters.highWater, now);
+        }
+
+        tag = counters.parent.load(std::memory_order_relaxed);
+    }
+}
+
+MemoryStats MemoryTracker::GetStats(uint32 tag)
+{
+    MemoryRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    if (tag >= registry.tagCount) return MemoryStats();
+
+    return GetTagStats(registry.tags[tag]);
+}
+
+MemoryStats MemoryTracker::GetTotalStats()
+{
+    MemoryRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    MemoryStats total;
+    uint32 count = registry.tagCount;
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        if (registry.tags[i].parent != NO_TAG) continue;
+
+        MemoryStats stats = GetTagStats(registry.tags[i]);
+
+        // the peaks of the tags may not have been at the same time,
+        // so this is an upper bound of the total high-water mark
+        total.bytes += stats.bytes;
+        total.highWater += stats.highWater;
+        total.liveAllocations += stats.liveAllocations;
+        total.allocations += stats.allocations;
+    }
+
+    return total;
+}
+
+void MemoryTracker::ResetHighWater()
+{
+    MemoryRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    uint32 count = registry.tagCount;
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        TagCounters& tag = registry.tags[i];
+        tag.highWater.store(tag.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void MemoryTracker::SetBudget(uint32 tag, uint64 bytes)
+{
+    MemoryRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    if (tag >= registry.tagCount) return;
+
+    registry.tags[tag].budget = bytes;
+    registry.tags[tag].overBudget = false;
+}
+
+uint32 MemoryTracker::CheckBudgets()
+{
+    MemoryRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    uint32 count = registry.tagCount;
+    uint32 overCount = 0;
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        TagCounters& tag = registry.tags[i];
+
+        if (tag.budget == 0) continue;
+
+        uint64 bytes = GetTagStats(tag).bytes;
+        bool over = bytes > tag.budget;
+
+        if (over && !tag.overBudget)
+        {
+            Logger::Warning("MemoryTracker: ", tag.name, " uses ", bytes, " bytes, over its budget of ", tag.budget);
+        }
+
+        tag.overBudget = over;
+        if (over) overCount++;
+    }
+
+    return overCount;
+}
+
+}
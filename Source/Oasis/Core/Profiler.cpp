@@ -0,0 +1,214 @@
+#include "Oasis/Core/Profiler.h"
+
+#include "Oasis/Core/TimeUtil.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+namespace Oasis
+{
+
+const uint32 Profiler::EVENTS_PER_THREAD = 1 << 16;
+const uint32 Profiler::MAX_DEPTH = 64;
+
+namespace
+{
+    struct ThreadBuffer
+    {
+        uint32 id;
+        std::string name;
+
+        // ring of finished zones, count is how many were ever written
+        std::vector<ProfileEvent> events;
+        std::atomic<uint64> count;
+
+        // zones that are open, only touched by the owning thread
+        const char* openNames[Profiler::MAX_DEPTH];
+        uint64 openStarts[Profiler::MAX_DEPTH];
+        uint32 depth;
+    };
+
+    // buffers are never freed, so traces can still be written
+    // after their threads exited
+    std::mutex registryMutex;
+    std::vector<ThreadBuffer*> buffers;
+    std::unordered_set<std::string> interned;
+
+    std::atomic<bool> enabled(false);
+    const uint64 epoch = Time::Nanos();
+
+    thread_local ThreadBuffer* threadBuffer = nullptr;
+
+    inline uint64 Now()
+    {
+        return Time::Nanos() - epoch;
+    }
+
+    ThreadBuffer* GetThreadBuffer()
+    {
+        if (!threadBuffer)
+        {
+            ThreadBuffer* buffer = new ThreadBuffer();
+            buffer->count = 0;
+            buffer->depth = 0;
+
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer->id = buffers.size() + 1;
+            buffer->name = "Thread " + std::to_string(buffer->id);
+            buffers.push_back(buffer);
+
+            threadBuffer = buffer;
+        }
+
+        return threadBuffer;
+    }
+
+    void WriteEscaped(std::ostream& out, const std::string& str)
+    {
+        out << '"';
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\') out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+            else out << c;
+        }
+        out << '"';
+    }
+}
+
+void Profiler::SetEnabled(bool enable)
+{
+    enabled = enable;
+}
+
+bool Profiler::IsEnabled()
+{
+    return enabled;
+}
+
+bool Profiler::BeginZone(const char* name)
+{
+    if (!enabled.load(std::memory_order_relaxed)) return false;
+
+    ThreadBuffer* buffer = GetThreadBuffer();
+
+    // only threads that record zones pay for a ring, the
+    // count stays 0 until it exists so exports skip it
+    if (buffer->events.empty()) buffer->events.resize(EVENTS_PER_THREAD);
+
+    if (buffer->depth < MAX_DEPTH)
+    {
+        buffer->openNames[buffer->depth] = name;
+        buffer->openStarts[buffer->depth] = Now();
+    }
+    buffer->depth++;
+
+    return true;
+}
+
+void Profiler::EndZone()
+{
+    // BeginZone created it
+    ThreadBuffer* buffer = threadBuffer;
+    uint32 depth = --buffer->depth;
+
+    if (depth < MAX_DEPTH)
+    {
+        uint64 index = buffer->count.load(std::memory_order_relaxed);
+
+        ProfileEvent& e = buffer->events[index % EVENTS_PER_THREAD];
+        e.name = buffer->openNames[depth];
+        e.start = buffer->openStarts[depth];
+        e.end = Now();
+        e.depth = depth;
+
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+    ThreadBuffer* buffer = GetThreadBuffer();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->name = name;
+}
+
+const char* Profiler::Intern(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    // nodes do not move, so the pointer stays valid
+    return interned.insert(name).first->c_str();
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+    std::ofstream out(path);
+
+    if (!out)
+    {
+        Logger::Error("Profiler: Could not open ", path);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    uint64 total = 0;
+
+    for (auto buffer : buffers)
+    {
+        out << (first ? "\n" : ",\n");
+        first = false;
+
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+        WriteEscaped(out, buffer->name);
+        out << "}}";
+
+        uint64 count = buffer->count.load(std::memory_order_acquire);
+        uint64 begin = count > EVENTS_PER_THREAD ? count - EVENTS_PER_THREAD : 0;
+
+        for (uint64 i = begin; i < count; i++)
+        {
+            const ProfileEvent& e = buffer->events[i % EVENTS_PER_THREAD];
+
+            // complete events, viewers nest them by time
+            out << ",\n{\"name\":";
+            WriteEscaped(out, e.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                << ",\"ts\":" << e.start / 1000.0
+                << ",\"dur\":" << (e.end - e.start) / 1000.0 << "}";
+        }
+
+        total += count - begin;
+    }
+
+    out << "\n]}\n";
+
+    if (!out)
+    {
+        Logger::Error("Profiler: Could not write ", path);
+        return false;
+    }
+
+    Logger::Info("Profiler: Wrote ", total, " zones to ", path);
+    return true;
+}
+
+void Profiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    for (auto buffer : buffers)
+    {
+        buffer->count = 0;
+    }
+}
+
+}
@@ -0,0 +1,271 @@
+#include "Oasis/Core/Telemetry.h"
+
+#include "Oasis/Core/MemoryTracker.h"
+#include "Oasis/Scene/Scene.h"
+#include "Oasis/Scene/SceneManager.h"
+#include "Oasis/Scene/System.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+namespace Oasis
+{
+
+TimeWindow::TimeWindow(uint32 capacity)
+    : samples_(capacity > 0 ? capacity : 1) {}
+
+void TimeWindow::Add(double seconds)
+{
+    samples_[next_] = seconds;
+    next_ = (next_ + 1) % samples_.size();
+    if (count_ < samples_.size()) count_++;
+}
+
+// nearest rank of a sorted list
+static double Percentile(const std::vector<double>& sorted, double p)
+{
+    uint32 rank = static_cast<uint32>(std::ceil(p * sorted.size()));
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+TimeStats TimeWindow::GetStats() const
+{
+    TimeStats stats;
+    if (count_ == 0) return stats;
+
+    std::vector<double> sorted(samples_.begin(), samples_.begin() + count_);
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0;
+    for (double s : sorted) total += s;
+
+    stats.average = total / count_;
+    stats.p50 = Percentile(sorted, 0.50);
+    stats.p95 = Percentile(sorted, 0.95);
+    stats.p99 = Percentile(sorted, 0.99);
+    stats.max = sorted.back();
+    stats.samples = count_;
+
+    return stats;
+}
+
+void TimeWindow::Clear()
+{
+    next_ = count_ = 0;
+}
+
+Telemetry::Telemetry(double hitchSeconds, uint32 windowSize)
+    : hitchSeconds_(hitchSeconds)
+    , frames_(windowSize)
+    , updates_(windowSize)
+    , renders_(windowSize) {}
+
+void Telemetry::AddFrame(double seconds, uint32 drawCalls)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    frames_.Add(seconds);
+    frameCount_++;
+    if (seconds > hitchSeconds_) hitchCount_++;
+
+    drawCalls_ = drawCalls;
+    totalDrawCalls_ += drawCalls;
+}
+
+void Telemetry::AddUpdate(double seconds)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    updates_.Add(seconds);
+}
+
+void Telemetry::AddRender(double seconds)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    renders_.Add(seconds);
+}
+
+void Telemetry::SetEntityCount(uint64 count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entityCount_ = count;
+}
+
+TimeStats Telemetry::GetFrameStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frames_.GetStats();
+}
+
+TimeStats Telemetry::GetUpdateStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return updates_.GetStats();
+}
+
+TimeStats Telemetry::GetRenderStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return renders_.GetStats();
+}
+
+uint64 Telemetry::GetFrameCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frameCount_;
+}
+
+uint64 Telemetry::GetHitchCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hitchCount_;
+}
+
+uint32 Telemetry::GetDrawCalls() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return drawCalls_;
+}
+
+uint64 Telemetry::GetTotalDrawCalls() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totalDrawCalls_;
+}
+
+uint64 Telemetry::GetEntityCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entityCount_;
+}
+
+static void WriteStats(std::ostream& out, const char* name, const TimeStats& stats)
+{
+    out << "  \"" << name << "\": { "
+        << "\"samples\": " << stats.samples
+        << ", \"averageMs\": " << stats.average * 1000
+        << ", \"p50Ms\": " << stats.p50 * 1000
+        << ", \"p95Ms\": " << stats.p95 * 1000
+        << ", \"p99Ms\": " << stats.p99 * 1000
+        << ", \"maxMs\": " << stats.max * 1000 << " },\n";
+}
+
+static void WriteString(std::ostream& out, const std::string& str)
+{
+    out << '"';
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+        else out << c;
+    }
+    out << '"';
+}
+
+bool Telemetry::WriteReport(const std::string& path, SceneManager* scenes) const
+{
+    std::ofstream out(path);
+
+    if (!out)
+    {
+        Logger::Error("Telemetry: Could not open ", path);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        out << std::fixed << std::setprecision(4);
+        out << "{\n";
+        WriteStats(out, "frame", frames_.GetStats());
+        WriteStats(out, "update", updates_.GetStats());
+        WriteStats(out, "render", renders_.GetStats());
+        out << "  \"frames\": " << frameCount_ << ",\n";
+        out << "  \"hitches\": " << hitchCount_ << ",\n";
+        out << "  \"hitchMs\": " << hitchSeconds_ * 1000 << ",\n";
+        out << "  \"drawCalls\": " << drawCalls_ << ",\n";
+        out << "  \"totalDrawCalls\": " << totalDrawCalls_ << ",\n";
+        out << "  \"entities\": " << entityCount_ << ",\n";
+    }
+
+    // empty unless the build tracks memory
+    out << "  \"memory\": [";
+
+    uint32 tagCount = MemoryTracker::IsEnabled() ? MemoryTracker::GetTagCount() : 0;
+
+    for (uint32 i = 0; i < tagCount; i++)
+    {
+        MemoryStats stats = MemoryTracker::GetStats(i);
+        uint32 parent = MemoryTracker::GetParent(i);
+
+        out << (i ? ",\n" : "\n") << "    { \"tag\": ";
+        WriteString(out, MemoryTracker::GetTagName(i));
+        out << ", \"parent\": ";
+        if (parent == MemoryTracker::NO_TAG) out << "null";
+        else WriteString(out, MemoryTracker::GetTagName(parent));
+        out << ", \"bytes\": " << stats.bytes
+            << ", \"highWater\": " << stats.highWater
+            << ", \"liveAllocations\": " << stats.liveAllocations
+            << ", \"allocations\": " << stats.allocations
+            << ", \"budget\": " << stats.budget << " }";
+    }
+
+    out << (tagCount ? "\n  ],\n" : "],\n");
+
+    out << "  \"scenes\": [";
+
+    uint32 sceneCount = scenes ? scenes->GetSceneCount() : 0;
+    uint32 written = 0;
+
+    for (uint32 i = 0; i < sceneCount; i++)
+    {
+        // unloaded scenes leave an empty slot
+        Scene* scene = scenes->GetSceneByIndex(i);
+        if (!scene) continue;
+
+        EntitySystemManager& systems = scene->GetSystemManager();
+
+        out << (written++ ? ",\n" : "\n") << "    { \"name\": ";
+        WriteString(out, scene->GetName());
+        out << ", \"entities\": " << scene->GetEntityManager().GetEntityCount() << ", \"systems\": [";
+
+        for (uint32 j = 0; j < systems.GetSystemCount(); j++)
+        {
+            EntitySystem* system = systems.GetSystem(j);
+
+            out << (j ? ",\n" : "\n") << "      { \"name\": ";
+            WriteString(out, system->GetName());
+            out << ", \"updateMs\": " << system->GetUpdateTime().seconds * 1000
+                << ", \"renderMs\": " << system->GetRenderTime().seconds * 1000 << " }";
+        }
+
+        out << (systems.GetSystemCount() ? "\n    ] }" : "] }");
+    }
+
+    out << (written ? "\n  ]\n}\n" : "]\n}\n");
+
+    if (!out)
+    {
+        Logger::Error("Telemetry: Could not write ", path);
+        return false;
+    }
+
+    Logger::Info("Telemetry: Wrote report to ", path);
+    return true;
+}
+
+void Telemetry::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    frames_.Clear();
+    updates_.Clear();
+    renders_.Clear();
+
+    frameCount_ = hitchCount_ = 0;
+    drawCalls_ = 0;
+    totalDrawCalls_ = 0;
+}
+
+}
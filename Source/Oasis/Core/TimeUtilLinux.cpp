@@ -2,6 +2,7 @@
 
 #include "Oasis/Core/TimeUtil.h" 
 
+#include <errno.h> 
 #include <time.h> 
 #include <unistd.h> 
 
@@ -25,6 +26,25 @@ void Sleep(uint64_t millis)
     usleep(millis * 1000); // accepts microseconds 
 }
 
+uint64_t Nanos() 
+{
+    struct timespec time; 
+
+    clock_gettime(CLOCK_MONOTONIC, &time); 
+
+    return time.tv_sec * 1000000000ULL + time.tv_nsec; 
+}
+
+void SleepNanos(uint64_t nanos) 
+{
+    struct timespec time; 
+    time.tv_sec = nanos / 1000000000ULL; 
+    time.tv_nsec = nanos % 1000000000ULL; 
+
+    // resumes after signals until the whole time has passed
+    while (nanosleep(&time, &time) == -1 && errno == EINTR) {} 
+}
+
 }
 
 }
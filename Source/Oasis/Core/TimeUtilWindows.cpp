@@ -20,6 +20,25 @@ void Sleep(uint64_t millis)
     ::Sleep(millis);
 }
 
+uint64_t Nanos()
+{
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+
+    // split to not overflow the multiplication
+    uint64_t seconds = count.QuadPart / freq.QuadPart;
+    uint64_t rest = count.QuadPart % freq.QuadPart;
+
+    return seconds * 1000000000ULL + rest * 1000000000ULL / freq.QuadPart;
+}
+
+void SleepNanos(uint64_t nanos)
+{
+    // rounds down, the caller spins for the rest
+    ::Sleep(static_cast<DWORD>(nanos / 1000000));
+}
+
 }
 
 }
@@ -6,6 +6,7 @@ namespace Oasis
 {
 
 Timer::Timer() 
+    : running_(true) 
 {
     Reset(); 
 } 
@@ -16,7 +17,7 @@ void Timer::Stop()
 {
     if (running_) 
     {
-        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop_); 
+        clock_gettime(CLOCK_MONOTONIC, &stop_); 
         running_ = false; 
     }
 } 
@@ -28,7 +29,7 @@ void Timer::Start()
 
 void Timer::Reset() 
 {
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start_); 
+    clock_gettime(CLOCK_MONOTONIC, &start_); 
     stop_ = start_; 
 } 
 
@@ -36,7 +37,7 @@ double Timer::GetSeconds()
 {
     if (running_) 
     {
-        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop_); 
+        clock_gettime(CLOCK_MONOTONIC, &stop_); 
     }
 
     return static_cast<double>(
@@ -2,6 +2,7 @@
 
 #include "Oasis/Core/Engine.h" 
 #include "Oasis/Core/Display.h" 
+#include "Oasis/Core/FrameArena.h" 
 #include "Oasis/Graphics/GL/GLIndexBuffer.h" 
 #include "Oasis/Graphics/GL/GLRenderTexture2D.h" 
 #include "Oasis/Graphics/GL/GLShader.h"
@@ -72,6 +73,9 @@ void GLGraphicsDevice::PreRender()
     SetShader(nullptr); 
     SetVertexBuffer(nullptr); 
     SetIndexBuffer(nullptr); 
+
+    drawCount_ = 0; 
+
     SetViewport(0, 0, d->GetWidth(), d->GetHeight()); 
     SetClearColor(0.7, 0.8, 0.9); 
     Clear(); 
@@ -179,6 +183,7 @@ void GLGraphicsDevice::DrawIndexed(Primitive prim, int start, int triCount)
     if (PrepareToDraw()) 
     {
         GLCALL(glDrawElements(/*PRIMITIVE_TYPES[(int) prim]*/ GL_TRIANGLES, triCount, GL_UNSIGNED_SHORT, (void*)(start * sizeof (short)))); 
+        drawCount_++; 
 
         PostDraw(); 
     } 
@@ -450,9 +455,10 @@ void GLGraphicsDevice::SetupFramebuffer()
         // GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, fbo_)); 
         BindFramebuffer(fbo_); 
 
-        vector<GLuint> drawBuffers; 
-        vector<GLuint> colorBuffers; 
-        vector<bool> isRenderbuffer; 
+        FrameArenaScope scope; 
+        FrameVector<GLuint> drawBuffers; 
+        FrameVector<GLuint> colorBuffers; 
+        FrameVector<bool> isRenderbuffer; 
 
         for (int i = 0; i < GetMaxRenderTargetCount(); i++) 
         {
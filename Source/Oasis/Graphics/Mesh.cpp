@@ -1,6 +1,7 @@
 #include "Oasis/Graphics/Mesh.h" 
 
 #include "Oasis/Core/Engine.h" 
+#include "Oasis/Core/FrameArena.h" 
 #include "Oasis/Graphics/IndexBuffer.h" 
 #include "Oasis/Graphics/VertexBuffer.h" 
 
@@ -88,7 +89,9 @@ void Mesh::UploadToGPU()
 
         //cout << "Mesh: format vertices" << endl; 
 
-        vector<float> vertices; 
+        // only needed until it is copied to the buffer
+        FrameArenaScope scope; 
+        FrameVector<float> vertices; 
         vertices.reserve(vertexCount_ * format.GetSize()); 
 
         for (int i = 0; i < vertexCount_; i++) 
@@ -0,0 +1,220 @@
+#include "Oasis/Graphics/Null/NullGraphicsDevice.h" 
+
+using namespace std; 
+
+namespace Oasis 
+{
+
+NullShader::NullShader(const string& vs, const string& fs) 
+    : Shader(vs, fs) 
+{
+    // nothing to compile, so it can not fail
+    valid_ = true; 
+}
+
+void NullShader::UploadToGPU() 
+{
+    updateParameters_.clear(); 
+}
+
+NullIndexBuffer::NullIndexBuffer(int startElements, BufferUsage usage) 
+    : IndexBuffer(startElements, usage) 
+{
+
+}
+
+void NullIndexBuffer::UploadToGPU() 
+{
+    dirty_ = false; 
+}
+
+NullVertexBuffer::NullVertexBuffer(int startElements, const VertexFormat& format, BufferUsage usage) 
+    : VertexBuffer(startElements, format, usage) 
+{
+
+}
+
+void NullVertexBuffer::UploadToGPU() 
+{
+    dirty_ = false; 
+}
+
+NullTexture2D::NullTexture2D(TextureFormat format, int width, int height) 
+    : Texture2D(format, width, height) 
+{
+
+}
+
+void NullTexture2D::Update() 
+{
+    dirtyParams_ = false; 
+    dirtyData_ = false; 
+}
+
+NullRenderTexture2D::NullRenderTexture2D(TextureFormat format, int width, int height, int samples) 
+    : RenderTexture2D(format, width, height, samples) 
+{
+
+}
+
+void NullRenderTexture2D::Update() 
+{
+    dirtyParams_ = false; 
+    dirtyData_ = false; 
+}
+
+void NullRenderTexture2D::ResolveTextureIfNeeded() {} 
+
+void NullRenderTexture2D::UpdateBackupTexture() {} 
+
+NullGraphicsDevice::NullGraphicsDevice() 
+{
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++) 
+    {
+        textureUnits_[i] = nullptr; 
+    }
+    for (int i = 0; i < MAX_RENDER_TARGETS; i++) 
+    {
+        renderTargets_[i] = nullptr; 
+    }
+}
+
+NullGraphicsDevice::~NullGraphicsDevice() {} 
+
+void NullGraphicsDevice::PreRender() 
+{
+    SetShader(nullptr); 
+    SetVertexBuffer(nullptr); 
+    SetIndexBuffer(nullptr); 
+    ClearRenderTargets(); 
+
+    drawCount_ = 0; 
+}
+
+void NullGraphicsDevice::PostRender() {} 
+
+void NullGraphicsDevice::SetClearColor(float r, float g, float b) 
+{
+    (void) r; 
+    (void) g; 
+    (void) b; 
+}
+
+void NullGraphicsDevice::Clear(bool colorBuffer, bool depthBuffer) 
+{
+    (void) colorBuffer; 
+    (void) depthBuffer; 
+}
+
+void NullGraphicsDevice::SetViewport(int x, int y, int w, int h) 
+{
+    (void) x; 
+    (void) y; 
+    (void) w; 
+    (void) h; 
+}
+
+void NullGraphicsDevice::SetShader(Shader* shader) 
+{
+    shader_ = shader; 
+}
+
+void NullGraphicsDevice::SetIndexBuffer(IndexBuffer* indexBuffer) 
+{
+    indexBuffer_ = indexBuffer; 
+}
+
+void NullGraphicsDevice::SetVertexBuffers(int count, VertexBuffer** vertexBuffers) 
+{
+    vertexBuffers_.clear(); 
+
+    for (int i = 0; i < count; i++) 
+    {
+        if (vertexBuffers[i]) vertexBuffers_.push_back(vertexBuffers[i]); 
+    }
+}
+
+void NullGraphicsDevice::SetTextureUnit(int unit, Texture* texture) 
+{
+    if (unit < 0 || unit >= MAX_TEXTURE_UNITS) 
+    {
+        Logger::Warning("NullGraphicsDevice: Texture unit ", unit, " is out of range"); 
+        return; 
+    }
+
+    textureUnits_[unit] = texture; 
+}
+
+void NullGraphicsDevice::ClearRenderTargets(bool color, bool depth) 
+{
+    if (color) 
+    {
+        for (int i = 0; i < MAX_RENDER_TARGETS; i++) 
+        {
+            renderTargets_[i] = nullptr; 
+        }
+    }
+
+    if (depth) depthTarget_ = nullptr; 
+}
+
+void NullGraphicsDevice::SetRenderTarget(int index, RenderTexture2D* texture) 
+{
+    if (index < 0 || index >= MAX_RENDER_TARGETS) 
+    {
+        Logger::Warning("NullGraphicsDevice: Render target ", index, " is out of range"); 
+        return; 
+    }
+
+    renderTargets_[index] = texture; 
+}
+
+void NullGraphicsDevice::SetDepthTarget(RenderTexture2D* texture) 
+{
+    depthTarget_ = texture; 
+}
+
+void NullGraphicsDevice::Draw(Primitive prim, int start, int triCount) 
+{
+    (void) prim; 
+    (void) start; 
+    (void) triCount; 
+
+    drawCount_++; 
+}
+
+void NullGraphicsDevice::DrawIndexed(Primitive prim, int start, int triCount) 
+{
+    (void) prim; 
+    (void) start; 
+    (void) triCount; 
+
+    drawCount_++; 
+}
+
+Shader* NullGraphicsDevice::CreateShader(const string& vs, const string& fs) 
+{
+    return new NullShader(vs, fs); 
+}
+
+IndexBuffer* NullGraphicsDevice::CreateIndexBuffer(int numElements, BufferUsage usage) 
+{
+    return new NullIndexBuffer(numElements, usage); 
+}
+
+VertexBuffer* NullGraphicsDevice::CreateVertexBuffer(int numElements, const VertexFormat& format, BufferUsage usage) 
+{
+    return new NullVertexBuffer(numElements, format, usage); 
+}
+
+Texture2D* NullGraphicsDevice::CreateTexture2D(TextureFormat format, int width, int height) 
+{
+    return new NullTexture2D(format, width, height); 
+}
+
+RenderTexture2D* NullGraphicsDevice::CreateRenderTexture2D(TextureFormat format, int width, int height, int samples) 
+{
+    return new NullRenderTexture2D(format, width, height, samples); 
+}
+
+}
@@ -0,0 +1,132 @@
+#pragma once 
+
+#include "Oasis/Graphics/GraphicsDevice.h" 
+#include "Oasis/Graphics/IndexBuffer.h" 
+#include "Oasis/Graphics/RenderTexture2D.h" 
+#include "Oasis/Graphics/Shader.h" 
+#include "Oasis/Graphics/Texture2D.h" 
+#include "Oasis/Graphics/VertexBuffer.h" 
+
+namespace Oasis 
+{
+
+// Resources of the null device keep their data on the CPU and are
+// never uploaded anywhere.
+
+class OASIS_API NullShader : public Shader 
+{
+public: 
+    NullShader(const std::string& vSource, const std::string& fSource); 
+
+private: 
+    void UploadToGPU() override; 
+};
+
+class OASIS_API NullIndexBuffer : public IndexBuffer 
+{
+public: 
+    NullIndexBuffer(int startElements, BufferUsage usage); 
+
+private: 
+    void UploadToGPU() override; 
+};
+
+class OASIS_API NullVertexBuffer : public VertexBuffer 
+{
+public: 
+    NullVertexBuffer(int startElements, const VertexFormat& format, BufferUsage usage); 
+
+private: 
+    void UploadToGPU() override; 
+};
+
+class OASIS_API NullTexture2D : public Texture2D 
+{
+public: 
+    NullTexture2D(TextureFormat format, int width, int height); 
+
+    void Update() override; 
+};
+
+class OASIS_API NullRenderTexture2D : public RenderTexture2D 
+{
+public: 
+    NullRenderTexture2D(TextureFormat format, int width, int height, int samples); 
+
+    void Update() override; 
+    void ResolveTextureIfNeeded() override; 
+    void UpdateBackupTexture() override; 
+};
+
+// Graphics device for running without a display or GPU. It creates
+// resources and keeps track of what is bound, but draws nothing.
+class OASIS_API NullGraphicsDevice : public GraphicsDevice 
+{
+public: 
+    static const int MAX_TEXTURE_UNITS = 8; 
+    static const int MAX_RENDER_TARGETS = 4; 
+
+    NullGraphicsDevice(); 
+    ~NullGraphicsDevice(); 
+
+    void SetClearColor(float r, float g, float b) override; 
+
+    void Clear(bool colorBuffer = true, bool depthBuffer = true) override; 
+
+    void SetViewport(int x, int y, int w, int h) override; 
+
+    void SetShader(Shader* shader) override; 
+
+    void SetIndexBuffer(IndexBuffer* indexBuffer) override; 
+
+    void SetVertexBuffers(int count, VertexBuffer** vertexBuffers) override; 
+
+    void SetTextureUnit(int unit, Texture* texture) override; 
+
+    inline int GetMaxRenderTargetCount() override { return MAX_RENDER_TARGETS; } 
+
+    void ClearRenderTargets(bool color = true, bool depth = true) override; 
+
+    void SetRenderTarget(int index, RenderTexture2D* texture) override; 
+
+    void SetDepthTarget(RenderTexture2D* texture) override; 
+
+    void Draw(Primitive prim, int start, int triCount) override; 
+
+    void DrawIndexed(Primitive prim, int start, int triCount) override; 
+
+    inline Shader* GetShader() override { return shader_; } 
+
+    inline IndexBuffer* GetIndexBuffer() override { return indexBuffer_; } 
+
+    inline int GetVertexBufferCount() override { return vertexBuffers_.size(); } 
+
+    inline VertexBuffer* GetVertexBuffer(int index) override { return vertexBuffers_[index]; } 
+
+    inline int GetMaxTextureUnitCount() override { return MAX_TEXTURE_UNITS; } 
+
+    inline Texture* GetTextureUnit(int unit) override { return textureUnits_[unit]; } 
+
+    Shader* CreateShader(const std::string& vSource, const std::string& fSource) override; 
+
+    IndexBuffer* CreateIndexBuffer(int numElements, BufferUsage usage = BufferUsage::DYNAMIC) override; 
+
+    VertexBuffer* CreateVertexBuffer(int numElements, const VertexFormat& format, BufferUsage usage = BufferUsage::DYNAMIC) override; 
+
+    Texture2D* CreateTexture2D(TextureFormat format, int width, int height) override; 
+
+    RenderTexture2D* CreateRenderTexture2D(TextureFormat format, int width, int height, int multisamples = 1) override; 
+
+private: 
+    void PreRender() override; 
+    void PostRender() override; 
+
+    Shader* shader_ = nullptr; 
+    IndexBuffer* indexBuffer_ = nullptr; 
+    std::vector<VertexBuffer*> vertexBuffers_; 
+    Texture* textureUnits_[MAX_TEXTURE_UNITS]; 
+    RenderTexture2D* renderTargets_[MAX_RENDER_TARGETS]; 
+    RenderTexture2D* depthTarget_ = nullptr; 
+};
+
+}
@@ -0,0 +1,223 @@
+#include "Oasis/Scene/Archetype.h" 
+
+#include "Oasis/Core/MemoryTracker.h" 
+
+#include <cstring> 
+
+namespace Oasis 
+{
+
+const uint32 EntityArchetype::CHUNK_SIZE = 16 * 1024; 
+const uint32 EntityArchetype::CHUNK_ALIGNMENT = 64; 
+
+static inline uint32 AlignUp(uint32 value, uint32 alignment) 
+{
+    return (value + alignment - 1) / alignment * alignment; 
+}
+
+EntityArchetype::EntityArchetype(const std::vector<const ComponentType*>& types, const ComponentMask& mask) 
+    : mask_(mask) 
+{
+    uint32 rowSize = sizeof (EntityId); 
+
+    for (auto type : types) 
+    {
+        Column c; 
+        c.type = type; 
+
+        if (type->storage == ComponentStorage::POOL) 
+        {
+            // only the slot in the pool is stored
+            c.size = sizeof (uint32); 
+            c.alignment = alignof (uint32); 
+        }
+        else 
+        {
+            c.size = type->size; 
+            c.alignment = type->alignment; 
+        }
+        c.offset = 0; 
+        c.changeOffset = 0; 
+
+        // over-aligned components need chunks aligned at least as much
+        if (c.alignment > chunkAlignment_) chunkAlignment_ = c.alignment; 
+
+        rowSize += c.size + sizeof (uint32); 
+        columns_.push_back(c); 
+        typeIds_.push_back(type->id); 
+    }
+
+    if (!typeIds_.empty()) 
+    {
+        // types are sorted, so the last id is the largest
+        columnIndices_.resize(typeIds_.back() + 1, -1); 
+
+        for (uint32 i = 0; i < typeIds_.size(); i++) 
+        {
+            columnIndices_[typeIds_[i]] = i; 
+        }
+    }
+
+    chunkCapacity_ = CHUNK_SIZE / rowSize; 
+    if (chunkCapacity_ == 0) chunkCapacity_ = 1; 
+
+    // lay out the columns, shrinking the capacity until
+    // alignment padding fits in the chunk
+    while (true) 
+    {
+        uint32 offset = sizeof (EntityId) * chunkCapacity_; 
+
+        for (auto& c : columns_) 
+        {
+            offset = AlignUp(offset, c.alignment); 
+            c.offset = offset; 
+            offset += c.size * chunkCapacity_; 
+        }
+
+        for (auto& c : columns_) 
+        {
+            offset = AlignUp(offset, alignof (uint32)); 
+            c.changeOffset = offset; 
+            offset += sizeof (uint32) * chunkCapacity_; 
+        }
+
+        chunkBytes_ = offset; 
+
+        if (chunkBytes_ <= CHUNK_SIZE || chunkCapacity_ == 1) break; 
+
+        chunkCapacity_--; 
+    }
+}
+
+EntityArchetype::~EntityArchetype() 
+{
+    // components are destroyed by the entity manager
+    for (auto allocation : allocations_) 
+    {
+        std::free(allocation); 
+        MemoryTracker::Freed(MemoryTracker::ARCHETYPES, GetAllocationBytes()); 
+    }
+}
+
+void EntityArchetype::Reserve(uint32 count) 
+{
+    uint32 chunkCount = (count_ + count + chunkCapacity_ - 1) / chunkCapacity_; 
+
+    chunks_.reserve(chunkCount); 
+    allocations_.reserve(chunkCount); 
+
+    while (chunks_.size() < chunkCount) 
+    {
+        AllocateChunk(); 
+    }
+}
+
+void EntityArchetype::AllocateChunk() 
+{
+    void* allocation = std::malloc(GetAllocationBytes()); 
+    uintptr_t aligned = ((uintptr_t) allocation + chunkAlignment_ - 1) / chunkAlignment_ * chunkAlignment_; 
+
+    allocations_.push_back(allocation); 
+    chunks_.push_back((uint8*) aligned); 
+    MemoryTracker::Allocated(MemoryTracker::ARCHETYPES, GetAllocationBytes()); 
+    chunkChangeVersions_.resize(chunks_.size() * columns_.size(), 0); 
+}
+
+uint32 EntityArchetype::AddRow(const EntityId& id) 
+{
+    uint32 row = count_; 
+
+    if (row / chunkCapacity_ >= chunks_.size()) 
+    {
+        AllocateChunk(); 
+    }
+
+    count_++; 
+    structureVersion_++; 
+
+    ((EntityId*)chunks_[row / chunkCapacity_])[row % chunkCapacity_] = id; 
+
+    return row; 
+}
+
+bool EntityArchetype::RemoveRow(uint32 row, EntityId& moved) 
+{
+    uint32 last = count_ - 1; 
+    bool didMove = false; 
+
+    if (row != last) 
+    {
+        // fill the hole with the last row
+        for (uint32 i = 0; i < columns_.size(); i++) 
+        {
+            MoveElement(i, GetElement(row, i), GetElement(last, i)); 
+            SetChangeVersion(row, i, GetChangeVersion(last, i)); 
+        }
+
+        moved = GetEntityId(last); 
+        ((EntityId*) chunks_[row / chunkCapacity_])[row % chunkCapacity_] = moved; 
+        didMove = true; 
+    }
+
+    count_--; 
+    structureVersion_++; 
+
+    // keep one spare chunk around so entities moving back and
+    // forth across a chunk boundary do not reallocate
+    TrimChunks(); 
+
+    return didMove; 
+}
+
+void EntityArchetype::TrimChunks() 
+{
+    while (chunks_.size() > GetChunkCount() + 1) 
+    {
+        std::free(allocations_.back()); 
+        MemoryTracker::Freed(MemoryTracker::ARCHETYPES, GetAllocationBytes()); 
+        allocations_.pop_back(); 
+        chunks_.pop_back(); 
+    }
+
+    chunkChangeVersions_.resize(chunks_.size() * columns_.size()); 
+}
+
+EntityArchetype* EntityArchetype::GetAddEdge(ClassId id) const 
+{
+    return id < addEdges_.size() ? addEdges_[id] : nullptr; 
+}
+
+EntityArchetype* EntityArchetype::GetRemoveEdge(ClassId id) const 
+{
+    return id < removeEdges_.size() ? removeEdges_[id] : nullptr; 
+}
+
+void EntityArchetype::SetAddEdge(ClassId id, EntityArchetype* archetype) 
+{
+    if (id >= addEdges_.size()) addEdges_.resize(id + 1, nullptr); 
+
+    addEdges_[id] = archetype; 
+}
+
+void EntityArchetype::SetRemoveEdge(ClassId id, EntityArchetype* archetype) 
+{
+    if (id >= removeEdges_.size()) removeEdges_.resize(id + 1, nullptr); 
+
+    removeEdges_[id] = archetype; 
+}
+
+void EntityArchetype::MoveElement(uint32 column, void* dest, void* src) 
+{
+    const Column& c = columns_[column]; 
+
+    if (c.type->storage == ComponentStorage::POOL) 
+    {
+        std::memcpy(dest, src, c.size); 
+    }
+    else 
+    {
+        c.type->move(dest, src); 
+    }
+}
+
+}
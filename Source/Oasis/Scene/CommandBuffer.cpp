@@ -0,0 +1,227 @@
+#include "Oasis/Scene/CommandBuffer.h" 
+
+#include "Oasis/Scene/EntityManager.h" 
+
+namespace Oasis 
+{
+
+const uint32 EntityCommandBuffer::PAGE_SIZE = 16 * 1024; 
+
+static uint8* AlignAddress(void* address, uint32 alignment) 
+{
+    return (uint8*) (((uintptr_t) address + alignment - 1) / alignment * alignment); 
+}
+
+EntityCommandBuffer::EntityCommandBuffer(EntityManager& manager) 
+    : manager_(manager) {} 
+
+EntityCommandBuffer::~EntityCommandBuffer() 
+{
+    Clear(); 
+
+    for (auto page : pages_) 
+    {
+        std::free(page); 
+    }
+}
+
+EntityId EntityCommandBuffer::CreateEntity() 
+{
+    Command c; 
+    c.type = CommandType::CREATE; 
+    c.id = manager_.ReserveEntityId(); 
+    c.componentId = 0; 
+    c.componentType = nullptr; 
+    c.data = nullptr; 
+
+    Record(c); 
+    return c.id; 
+}
+
+void EntityCommandBuffer::DestroyEntity(const EntityId& id) 
+{
+    Command c; 
+    c.type = CommandType::DESTROY; 
+    c.id = id; 
+    c.componentId = 0; 
+    c.componentType = nullptr; 
+    c.data = nullptr; 
+
+    Record(c); 
+}
+
+Component* EntityCommandBuffer::AttachComponent(const EntityId& id, const ComponentType& type, const Component* from) 
+{
+    Command c; 
+    c.type = CommandType::ATTACH; 
+    c.id = id; 
+    c.componentId = type.id; 
+    c.componentType = &type; 
+    c.data = Allocate(type.size, type.alignment); 
+
+    type.copy(c.data, from); 
+
+    Record(c); 
+    return (Component*) c.data; 
+}
+
+void EntityCommandBuffer::DetachComponent(const EntityId& id, ClassId compId) 
+{
+    Command c; 
+    c.type = CommandType::DETACH; 
+    c.id = id; 
+    c.componentId = compId; 
+    c.componentType = nullptr; 
+    c.data = nullptr; 
+
+    Record(c); 
+}
+
+bool EntityCommandBuffer::Playback() 
+{
+    EntityCommandBuffer* buffer = this; 
+    return Playback(&buffer, 1); 
+}
+
+bool EntityCommandBuffer::Playback(EntityCommandBuffer* const* buffers, uint32 count) 
+{
+    if (count == 0) return true; 
+
+    if (buffers[0]->manager_.IsLocked()) 
+    {
+        Logger::Warning("EntityCommandBuffer: Cannot play back while the entity manager is locked"); 
+        return false; 
+    }
+
+    if (count == 1) 
+    {
+        for (auto& c : buffers[0]->commands_) 
+        {
+            buffers[0]->Apply(c); 
+        }
+    }
+    else 
+    {
+        // merge by sequence, there are only as many buffers as threads
+        std::vector<uint32> next(count, 0); 
+
+        while (true) 
+        {
+            int first = -1; 
+            uint64 sequence = 0; 
+
+            for (uint32 i = 0; i < count; i++) 
+            {
+                auto& commands = buffers[i]->commands_; 
+
+                if (next[i] < commands.size() && (first < 0 || commands[next[i]].sequence < sequence)) 
+                {
+                    first = i; 
+                    sequence = commands[next[i]].sequence; 
+                }
+            }
+
+            if (first < 0) break; 
+
+            buffers[first]->Apply(buffers[first]->commands_[next[first]++]); 
+        }
+    }
+
+    for (uint32 i = 0; i < count; i++) 
+    {
+        buffers[i]->commands_.clear(); 
+        buffers[i]->ReleaseMemory(); 
+    }
+
+    return true; 
+}
+
+void EntityCommandBuffer::Record(Command& c) 
+{
+    c.sequence = manager_.commandSequence_.fetch_add(1, std::memory_order_relaxed); 
+    commands_.push_back(c); 
+}
+
+void EntityCommandBuffer::Apply(Command& c) 
+{
+    switch (c.type) 
+    {
+    case CommandType::CREATE: 
+        manager_.CreateReservedEntityId(c.id); 
+        break; 
+    case CommandType::DESTROY: 
+        manager_.DestroyEntityId(c.id); 
+        break; 
+    case CommandType::ATTACH: 
+        manager_.AttachComponent(c.id, *c.componentType, (const Component*) c.data); 
+        c.componentType->destroy(c.data); 
+        break; 
+    case CommandType::DETACH: 
+        manager_.DetachComponent(c.id, c.componentId); 
+        break; 
+    default: 
+        Logger::Warning("EntityCommandBuffer: Unknown Command Type: ", (int) c.type); 
+    }
+}
+
+void EntityCommandBuffer::Clear() 
+{
+    for (auto& c : commands_) 
+    {
+        if (c.type == CommandType::CREATE) 
+        {
+            manager_.ReleaseReservedEntityId(c.id); 
+        }
+        else if (c.type == CommandType::ATTACH) 
+        {
+            c.componentType->destroy(c.data); 
+        }
+    }
+
+    commands_.clear(); 
+    ReleaseMemory(); 
+}
+
+void EntityCommandBuffer::ReleaseMemory() 
+{
+    // pages are kept for the next recording
+    page_ = 0; 
+    pageOffset_ = 0; 
+
+    for (auto data : largeAllocations_) 
+    {
+        std::free(data); 
+    }
+    largeAllocations_.clear(); 
+}
+
+void* EntityCommandBuffer::Allocate(uint32 size, uint32 alignment) 
+{
+    if (size + alignment > PAGE_SIZE) 
+    {
+        // oversized components get their own allocation
+        void* data = std::malloc(size + alignment); 
+        largeAllocations_.push_back(data); 
+        return AlignAddress(data, alignment); 
+    }
+
+    // the address is aligned, malloc only aligns pages for basic types
+    uint8* data = page_ < pages_.size() ? AlignAddress(pages_[page_] + pageOffset_, alignment) : nullptr; 
+
+    if (!data || data + size > pages_[page_] + PAGE_SIZE) 
+    {
+        if (page_ < pages_.size()) page_++; 
+
+        if (page_ >= pages_.size()) 
+        {
+            pages_.push_back((uint8*) std::malloc(PAGE_SIZE)); 
+        }
+
+        data = AlignAddress(pages_[page_], alignment); 
+    }
+
+    pageOffset_ = data + size - pages_[page_]; 
+    return data; 
+}
+
+}
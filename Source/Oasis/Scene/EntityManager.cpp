@@ -1,185 +1,836 @@
 #include "Oasis/Scene/EntityManager.h" 
 
+#include <algorithm> 
+#include <atomic> 
+
 namespace Oasis
 {
 
+namespace 
+{
+    struct CommandBufferCache 
+    {
+        uint64 serial; 
+        EntityCommandBuffer* buffer; 
+    };
+
+    // last command buffer used by this thread, tagged with the
+    // serial of its manager so a reused address is not mistaken
+    thread_local CommandBufferCache commandBufferCache = { 0, nullptr }; 
+
+    struct WriteVersion 
+    {
+        uint64 serial; 
+        uint32 version; 
+    };
+
+    // version of the system run in progress on this thread, tagged
+    // with the serial of its manager
+    thread_local WriteVersion writeVersion = { 0, 0 }; 
+
+    std::atomic<uint64> nextSerial(1); 
+}
+
 EntityManager::EntityManager() 
     : filterCache_(this) 
+    , lockCount_(0) 
+    , changeVersion_(1) 
+    , commandSequence_(0) 
+    , serial_(nextSerial++) 
 {
-
+    emptyArchetype_ = GetArchetype(std::vector<const ComponentType*>()); 
 }
 
 EntityManager::~EntityManager() 
 {
-    // TODO 
-    for (auto it = componentPools_.begin(); it != componentPools_.end(); it++) 
+    // drop unplayed commands while components can still be destroyed
+    for (auto& pair : commandBuffers_) 
     {
-        delete it->second; 
+        delete pair.second; 
+    }
+    commandBuffers_.clear(); 
+
+    // destroy components still stored in archetypes
+    for (auto archetype : archetypes_) 
+    {
+        for (uint32 row = 0; row < archetype->GetEntityCount(); row++) 
+        {
+            for (uint32 col = 0; col < archetype->GetColumnCount(); col++) 
+            {
+                if (archetype->GetColumnType(col).storage == ComponentStorage::ARCHETYPE) 
+                {
+                    archetype->GetColumnType(col).destroy(archetype->GetElement(row, col)); 
+                }
+            }
+        }
+
+        delete archetype; 
+    }
+    archetypes_.clear(); 
+
+    // pools destroy their remaining components
+    for (auto pool : componentPools_) 
+    {
+        delete pool; 
     }
     componentPools_.clear(); 
 }
 
-EntityId EntityManager::CreateEntityId() 
+void EntityManager::Lock() 
+{
+    lockCount_++; 
+}
+
+void EntityManager::Unlock() 
+{
+    uint32 count = lockCount_.load(); 
+
+    do 
+    {
+        if (!count) 
+        {
+            Logger::Warning("EntityManager: Unlock called without matching Lock"); 
+            return; 
+        }
+    }
+    while (!lockCount_.compare_exchange_weak(count, count - 1)); 
+
+    if (count == 1) 
+    {
+        PlaybackCommandBuffers(); 
+    }
+}
+
+EntityCommandBuffer& EntityManager::GetCommandBuffer() 
+{
+    if (commandBufferCache.serial == serial_) 
+    {
+        return *commandBufferCache.buffer; 
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_); 
+
+    std::thread::id thread = std::this_thread::get_id(); 
+    EntityCommandBuffer* buffer = nullptr; 
+
+    for (auto& pair : commandBuffers_) 
+    {
+        if (pair.first == thread) buffer = pair.second; 
+    }
+
+    if (!buffer) 
+    {
+        buffer = new EntityCommandBuffer(*this); 
+        commandBuffers_.push_back(std::make_pair(thread, buffer)); 
+    }
+
+    commandBufferCache.serial = serial_; 
+    commandBufferCache.buffer = buffer; 
+
+    return *buffer; 
+}
+
+EntityId EntityManager::ReserveEntityId() 
 {
+    std::lock_guard<std::mutex> lock(mutex_); 
+
     uint32 id = ids_.Get(); 
+    return EntityId(id, TakeNextVersion(id)); 
+}
 
-    if (id == entities_.size()) 
+uint32 EntityManager::TakeNextVersion(uint32 id) 
+{
+    auto released = releasedVersions_.find(id); 
+
+    if (released != releasedVersions_.end()) 
     {
-        entities_.push_back(EntityEntry()); 
+        uint32 version = released->second + 1; 
+        releasedVersions_.erase(released); 
+        return version; 
     }
 
-    entities_[id].OnCreate(); 
+    // entries are only written when unlocked, reading the
+    // previous version of a reused id is safe here
+    return id < entities_.size() ? entities_[id].version + 1 : 1; 
+}
 
-    EntityId eid = EntityId(id, entities_[id].version); 
-    filterCache_.OnCreateEntity(eid); 
+EntityId EntityManager::CreateEntityId() 
+{
+    if (IsLocked()) 
+    {
+        return GetCommandBuffer().CreateEntity(); 
+    }
+
+    EntityId eid = ReserveEntityId(); 
+    CreateReservedEntityId(eid); 
 
     return eid; 
 }
 
+bool EntityManager::CreateReservedEntityId(const EntityId& eid) 
+{
+    if (eid.id >= entities_.size()) 
+    {
+        entities_.resize(eid.id + 1); 
+    }
+
+    EntityEntry& entity = entities_[eid.id]; 
+
+    if (entity.valid) return false; 
+
+    entity.OnCreate(eid.version); 
+    entity.archetype = emptyArchetype_; 
+    entity.row = emptyArchetype_->AddRow(eid); 
+
+    filterCache_.OnCreateEntity(eid, emptyArchetype_); 
+
+    return true; 
+}
+
+void EntityManager::ReleaseReservedEntityId(const EntityId& eid) 
+{
+    std::lock_guard<std::mutex> lock(mutex_); 
+
+    // keep the version so the id is not handed out again as-is, the
+    // table is not grown as it may be read by other threads
+    if (eid.id < entities_.size()) 
+    {
+        entities_[eid.id].version = eid.version; 
+    }
+    else 
+    {
+        releasedVersions_[eid.id] = eid.version; 
+    }
+
+    ids_.Release(eid.id); 
+}
+
+void EntityManager::PlaybackCommandBuffers() 
+{
+    playbackBuffers_.clear(); 
+
+    for (auto& pair : commandBuffers_) 
+    {
+        if (!pair.second->IsEmpty()) playbackBuffers_.push_back(pair.second); 
+    }
+
+    EntityCommandBuffer::Playback(playbackBuffers_.data(), playbackBuffers_.size()); 
+}
+
 bool EntityManager::DestroyEntityId(const EntityId& id) 
 {
-    if (!IdInBounds(id.id)) return false; 
+    if (IsLocked()) 
+    {
+        // recorded either way, the id may be reserved for an entity
+        // created by a command that was not played back yet
+        GetCommandBuffer().DestroyEntity(id); 
+        return GetValidEntry(id) != nullptr; 
+    }
 
-    EntityEntry& entity = entities_[id.id]; 
+    EntityEntry* entity = GetValidEntry(id); 
+
+    if (!entity) return false; 
 
-    if (!entity.valid || entity.version != id.version) return false; 
+    EntityArchetype* archetype = entity->archetype; 
 
-    for (unsigned i = 0; i < entity.components.size(); i++) 
+    for (uint32 col = 0; col < archetype->GetColumnCount(); col++) 
     {
-        auto& pair = entity.components[i]; 
-        componentPools_[pair.first]->DestroyComponent(pair.second); 
+        DestroyElement(archetype, entity->row, col); 
+    }
+
+    RemoveRow(archetype, entity->row); 
+
+    entity->OnDestroy(); 
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_); 
+        ids_.Release(id.id); 
     }
 
-    entity.OnDestroy(); 
     filterCache_.OnDestroyEntity(id); 
     return true; 
 }
 
-bool EntityManager::IsValidEntityId(const EntityId& id) const 
+void EntityManager::CreateEntities(uint32 count, const std::vector<const ComponentType*>& types, const std::vector<const Component*>& prototypes, EntityId* out) 
 {
-    // id in bounds 
-    if (!IdInBounds(id.id)) return false; 
+    if (!count) return; 
 
-    const EntityEntry& entity = entities_[id.id]; 
+    // sort by id, keeping each prototype with its type
+    std::vector<std::pair<const ComponentType*, const Component*>> components; 
+    for (uint32 i = 0; i < types.size(); i++) 
+    {
+        components.push_back(std::make_pair(types[i], i < prototypes.size() ? prototypes[i] : nullptr)); 
+    }
 
-    // entity still valid for id
-    return entity.valid && entity.version == id.version; 
+    std::stable_sort(components.begin(), components.end(), 
+        [](const std::pair<const ComponentType*, const Component*>& a, const std::pair<const ComponentType*, const Component*>& b) -> bool 
+        {
+            return a.first->id < b.first->id; 
+        }
+    ); 
+
+    std::vector<const ComponentType*> sortedTypes; 
+    std::vector<const Component*> sortedPrototypes; 
+    for (auto& c : components) 
+    {
+        // a repeated type keeps its first prototype
+        if (!sortedTypes.empty() && sortedTypes.back()->id == c.first->id) continue; 
+
+        sortedTypes.push_back(c.first); 
+        sortedPrototypes.push_back(c.second); 
+    }
+
+    if (IsLocked()) 
+    {
+        EntityCommandBuffer& buffer = GetCommandBuffer(); 
+
+        for (uint32 i = 0; i < count; i++) 
+        {
+            EntityId id = buffer.CreateEntity(); 
+
+            for (uint32 j = 0; j < sortedTypes.size(); j++) 
+            {
+                buffer.AttachComponent(id, *sortedTypes[j], sortedPrototypes[j]); 
+            }
+
+            if (out) out[i] = id; 
+        }
+
+        return; 
+    }
+
+    CreateEntitiesIn(count, GetArchetype(sortedTypes), sortedPrototypes, out); 
+}
+
+bool EntityManager::CreateEntities(uint32 count, const EntityId& prototype, EntityId* out) 
+{
+    EntityEntry* entity = GetValidEntry(prototype); 
+
+    if (!entity) return false; 
+
+    EntityArchetype* archetype = entity->archetype; 
+
+    if (IsLocked()) 
+    {
+        std::vector<const ComponentType*> types; 
+        std::vector<const Component*> prototypes; 
+
+        for (uint32 col = 0; col < archetype->GetColumnCount(); col++) 
+        {
+            types.push_back(&archetype->GetColumnType(col)); 
+            prototypes.push_back(GetElementComponent(archetype, entity->row, col)); 
+        }
+
+        CreateEntities(count, types, prototypes, out); 
+        return true; 
+    }
+
+    std::vector<const Component*> prototypes; 
+    for (uint32 col = 0; col < archetype->GetColumnCount(); col++) 
+    {
+        prototypes.push_back(GetElementComponent(archetype, entity->row, col)); 
+    }
+
+    CreateEntitiesIn(count, archetype, prototypes, out); 
+    return true; 
+}
+
+void EntityManager::ReserveStorage(EntityArchetype* archetype, uint32 count) 
+{
+    archetype->Reserve(count); 
+
+    for (uint32 col = 0; col < archetype->GetColumnCount(); col++) 
+    {
+        const ComponentType& type = archetype->GetColumnType(col); 
+
+        if (type.storage == ComponentStorage::POOL) 
+        {
+            ComponentPoolBase* pool = GetOrCreatePool(type); 
+            pool->Reserve(pool->GetSize() + count); 
+        }
+    }
+}
+
+void EntityManager::CreateEntitiesIn(uint32 count, EntityArchetype* archetype, const std::vector<const Component*>& prototypes, EntityId* out) 
+{
+    ReserveStorage(archetype, count); 
+
+    std::vector<EntityId> local; 
+    if (!out) 
+    {
+        local.resize(count); 
+        out = &local[0]; 
+    }
+
+    uint32 end = entities_.size(); 
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_); 
+
+        for (uint32 i = 0; i < count; i++) 
+        {
+            uint32 id = ids_.Get(); 
+            out[i] = EntityId(id, TakeNextVersion(id)); 
+            if (id >= end) end = id + 1; 
+        }
+    }
+
+    if (end > entities_.size()) 
+    {
+        entities_.resize(end); 
+    }
+
+    for (uint32 i = 0; i < count; i++) 
+    {
+        EntityEntry& entity = entities_[out[i].id]; 
+
+        entity.OnCreate(out[i].version); 
+        entity.archetype = archetype; 
+        entity.row = archetype->AddRow(out[i]); 
+
+        for (uint32 col = 0; col < archetype->GetColumnCount(); col++) 
+        {
+            ConstructElement(archetype, entity.row, col, prototypes[col]); 
+        }
+    }
+
+    filterCache_.OnCreateEntities(out, count, archetype); 
+}
+
+uint32 EntityManager::DestroyEntities(const EntityId* ids, uint32 count) 
+{
+    if (IsLocked()) 
+    {
+        EntityCommandBuffer& buffer = GetCommandBuffer(); 
+        uint32 valid = 0; 
+
+        for (uint32 i = 0; i < count; i++) 
+        {
+            buffer.DestroyEntity(ids[i]); 
+            if (GetValidEntry(ids[i])) valid++; 
+        }
+
+        return valid; 
+    }
+
+    std::vector<uint32> released; 
+    released.reserve(count); 
+
+    for (uint32 i = 0; i < count; i++) 
+    {
+        EntityEntry* entity = GetValidEntry(ids[i]); 
+
+        if (!entity) continue; 
+
+        EntityArchetype* archetype = entity->archetype; 
+
+        for (uint32 col = 0; col < archetype->GetColumnCount(); col++) 
+        {
+            DestroyElement(archetype, entity->row, col); 
+        }
+
+        RemoveRow(archetype, entity->row); 
+        entity->OnDestroy(); 
+
+        released.push_back(ids[i].id); 
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_); 
+
+        for (auto id : released) 
+        {
+            ids_.Release(id); 
+        }
+    }
+
+    filterCache_.OnDestroyEntities(ids, count); 
+    return released.size(); 
+}
+
+bool EntityManager::IsValidEntityId(const EntityId& id) const 
+{
+    return GetValidEntry(id) != nullptr; 
 }
 
 bool EntityManager::HasComponent(const EntityId& id, ClassId compId) const 
 {
-    // id in bounds 
-    if (!IdInBounds(id.id)) return false; 
+    const EntityEntry* entity = GetValidEntry(id); 
 
-    const EntityEntry& entity = entities_[id.id]; 
+    if (!entity) return false; 
 
-    // entity still valid for id
-    if (!entity.valid || entity.version != id.version) return false; 
+    return entity->archetype->Has(compId); 
+}
+
+EntityArchetype* EntityManager::GetArchetype(const EntityId& id) const 
+{
+    const EntityEntry* entity = GetValidEntry(id); 
 
-    return FindComponentIndex(id.id, compId) != -1; 
+    return entity ? entity->archetype : nullptr; 
 }
 
-Component* EntityManager::GetComponent(const EntityId& id, ClassId compId) 
+ComponentPoolBase* EntityManager::GetComponentPool(ClassId compId) const 
 {
-    // id in bounds 
-    if (!IdInBounds(id.id)) return nullptr; 
+    return compId < componentPools_.size() ? componentPools_[compId] : nullptr; 
+}
 
-    EntityEntry& entity = entities_[id.id]; 
+Component* EntityManager::GetComponent(const EntityId& id, ClassId compId) 
+{
+    EntityEntry* entity = GetValidEntry(id); 
 
-    // entity still valid for id
-    if (!entity.valid || entity.version != id.version) return nullptr; 
+    if (!entity) return nullptr; 
 
-    int index = FindComponentIndex(id.id, compId); 
+    int col = entity->archetype->GetColumnIndex(compId); 
 
     // check entity has component 
-    if (index == -1) return nullptr; 
+    if (col == -1) return nullptr; 
+
+    return GetElementComponent(entity->archetype, entity->row, col); 
+}
 
-    uint32 poolIndex = entity.components[index].second; 
-    ComponentPoolBase* pool = componentPools_[compId];
+uint32 EntityManager::NextChangeVersion() 
+{
+    uint32 version = changeVersion_.load(); 
+    uint32 next; 
 
-    return pool->GetComponent(poolIndex); 
+    // 0 stands for a system that never ran, so it is skipped when
+    // the counter wraps around
+    do 
+    {
+        next = version + 1 ? version + 1 : 1; 
+    }
+    while (!changeVersion_.compare_exchange_weak(version, next)); 
+
+    return version; 
 }
 
-Component* EntityManager::AttachComponent(const EntityId& id, ClassId compId, const Component& from) 
+uint32 EntityManager::GetWriteVersion() const 
 {
-    // id in bounds 
-    if (!IdInBounds(id.id)) return nullptr; 
+    if (writeVersion.serial == serial_) return writeVersion.version; 
 
-    EntityEntry& entity = entities_[id.id]; 
+    return GetChangeVersion(); 
+}
 
-    // entity still valid for id
-    if (!entity.valid || entity.version != id.version) return nullptr; 
+Component* EntityManager::GetMutableComponent(const EntityId& id, ClassId compId) 
+{
+    EntityEntry* entity = GetValidEntry(id); 
 
-    int index = FindComponentIndex(id.id, compId); 
+    if (!entity) return nullptr; 
 
-    ComponentPoolBase* pool = componentPools_[compId]; 
+    int col = entity->archetype->GetColumnIndex(compId); 
 
-    // check entity has component 
-    if (index != -1) 
+    if (col == -1) return nullptr; 
+
+    entity->archetype->SetChangeVersion(entity->row, col, GetWriteVersion()); 
+
+    return GetElementComponent(entity->archetype, entity->row, col); 
+}
+
+bool EntityManager::MarkChanged(const EntityId& id, ClassId compId) 
+{
+    EntityEntry* entity = GetValidEntry(id); 
+
+    if (!entity) return false; 
+
+    int col = entity->archetype->GetColumnIndex(compId); 
+
+    if (col == -1) return false; 
+
+    entity->archetype->SetChangeVersion(entity->row, col, GetWriteVersion()); 
+
+    return true; 
+}
+
+Component* EntityManager::AttachComponent(const EntityId& id, const ComponentType& type, const Component* from) 
+{
+    if (IsLocked()) 
     {
-        // entity already has component 
-        uint32& poolIndex = entity.components[index].second; 
-        pool->DestroyComponent(poolIndex); 
+        return GetCommandBuffer().AttachComponent(id, type, from); 
+    }
 
-        poolIndex = pool->CreateComponent(&from); 
+    EntityEntry* entity= GetValidEntry(id); 
 
-        return pool->GetComponent(poolIndex); 
+    if (!entity) return nullptr; 
+
+    int col = entity->archetype->GetColumnIndex(type.id); 
+
+    // check entity has component 
+    if (col != -1) 
+    {
+        // entity already has component, replace it in place
+        DestroyElement(entity->archetype, entity->row, col); 
+        ConstructElement(entity->archetype, entity->row, col, from); 
+
+        return GetElementComponent(entity->archetype, entity->row, col); 
     }
     else 
     {
-        uint32 newPoolIndex = pool->CreateComponent(&from); 
-        entity.components.push_back(std::make_pair(compId, newPoolIndex)); 
+        EntityArchetype* src = entity->archetype; 
+        EntityArchetype* dest = GetArchetypeWith(src, type); 
+
+        uint32 row = MoveEntity(*entity, dest); 
+        col = dest->GetColumnIndex(type.id); 
+        ConstructElement(dest, row, col, from); 
 
         // did not already have component, just adding now 
-        filterCache_.OnAddEntityComponent(id, compId); 
+        filterCache_.OnChangeEntityArchetype(id, src, dest); 
 
-        return pool->GetComponent(newPoolIndex); 
+        return GetElementComponent(dest, row, col); 
     }
 }
 
 bool EntityManager::DetachComponent(const EntityId& id, ClassId compId) 
+{
+    if (IsLocked()) 
+    {
+        GetCommandBuffer().DetachComponent(id, compId); 
+        return true; 
+    }
+
+    EntityEntry* entity= GetValidEntry(id); 
+
+    if (!entity) return false; 
+
+    int col = entity->archetype->GetColumnIndex(compId); 
+
+    // check entity has component 
+    if (col == -1) return false; 
+
+    EntityArchetype* src = entity->archetype; 
+    EntityArchetype* dest = GetArchetypeWithout(src, compId); 
+
+    DestroyElement(src, entity->row, col); 
+    MoveEntity(*entity, dest); 
+
+    filterCache_.OnChangeEntityArchetype(id, src, dest); 
+
+    return true; 
+}
+
+bool EntityManager::IdInBounds(uint32 id) const 
+{
+    return id < entities_.size(); 
+}
+
+EntityManager::EntityEntry* EntityManager::GetValidEntry(const EntityId& id) 
 {
     // id in bounds
-    if (!IdInBounds(id.id)) return false; 
- 
+    if (!IdInBounds(id.id)) return nullptr; 
+
     EntityEntry& entity = entities_[id.id]; 
 
     // entity still valid for id
-    if (!entity.valid || entity.version != id.version) return false; 
+    if (!entity.valid || entity.version != id.version) return nullptr; 
 
-    int index = FindComponentIndex(id.id, compId); 
+    return &entity; 
+}
 
-    // check entity has component 
-    if (index == -1) return false; 
+const EntityManager::EntityEntry* EntityManager::GetValidEntry(const EntityId& id) const 
+{
+    // id in bounds
+    if (!IdInBounds(id.id)) return nullptr; 
 
-    uint32 poolIndex = entity.components[index].second; 
-    ComponentPoolBase* pool = componentPools_[compId];
+    const EntityEntry& entity = entities_[id.id]; 
 
-    pool->DestroyComponent(poolIndex); 
+    // entity still valid for id
+    if (!entity.valid || entity.version != id.version) return nullptr; 
 
-    entity.components[index] = entity.components[entity.components.size() - 1]; 
-    entity.components.pop_back(); 
+    return &entity; 
+}
 
-    filterCache_.OnRemoveEntityComponent(id, compId); 
+Component* EntityManager::GetElementComponent(EntityArchetype* archetype, uint32 row, uint32 column) 
+{
+    void* element = archetype->GetElement(row, column); 
+    const ComponentType& type = archetype->GetColumnType(column); 
 
-    return true; 
+    if (type.storage == ComponentStorage::POOL) 
+    {
+        return componentPools_[type.id]->GetComponent(*(uint32*) element); 
+    }
+    else 
+    {
+        return (Component*) element; 
+    }
 }
 
-bool EntityManager::IdInBounds(uint32 id) const 
+ComponentPoolBase* EntityManager::GetOrCreatePool(const ComponentType& type) 
+{
+    if (type.id >= componentPools_.size()) componentPools_.resize(type.id + 1, nullptr); 
+
+    ComponentPoolBase*& pool = componentPools_[type.id]; 
+    if (!pool) pool = type.createPool(); 
+
+    return pool; 
+}
+
+void EntityManager::ConstructElement(EntityArchetype* archetype, uint32 row, uint32 column, const void* from) 
+{
+    void* element = archetype->GetElement(row, column); 
+    const ComponentType& type = archetype->GetColumnType(column); 
+
+    if (type.storage == ComponentStorage::POOL) 
+    {
+        *(uint32*) element = GetOrCreatePool(type)->CreateComponent((const Component*) from); 
+    }
+    else 
+    {
+        type.copy(element, from); 
+    }
+
+    archetype->SetChangeVersion(row, column, GetChangeVersion()); 
+}
+
+void EntityManager::DestroyElement(EntityArchetype* archetype, uint32 row, uint32 column) 
+{
+    void* element = archetype->GetElement(row, column); 
+    const ComponentType& type = archetype->GetColumnType(column); 
+
+    if (type.storage == ComponentStorage::POOL) 
+    {
+        componentPools_[type.id]->DestroyComponent(*(uint32*) element); 
+    }
+    else 
+    {
+        type.destroy(element); 
+    }
+}
+
+uint32 EntityManager::MoveEntity(EntityEntry& entity, EntityArchetype* dest) 
+{
+    EntityArchetype* src = entity.archetype; 
+    uint32 srcRow = entity.row; 
+
+    uint32 destRow = dest->AddRow(src->GetEntityId(srcRow)); 
+
+    // columns are sorted by id in both archetypes
+    uint32 destCol = 0; 
+    for (uint32 srcCol = 0; srcCol < src->GetColumnCount(); srcCol++) 
+    {
+        ClassId compId = src->GetTypeIds()[srcCol]; 
+
+        while (destCol < dest->GetColumnCount() && dest->GetTypeIds()[destCol] < compId) destCol++; 
+
+        // component was removed, already destroyed by caller
+        if (destCol == dest->GetColumnCount() || dest->GetTypeIds()[destCol] != compId) continue; 
+
+        const ComponentType& type = src->GetColumnType(srcCol); 
+        void* from = src->GetElement(srcRow, srcCol); 
+        void* to = dest->GetElement(destRow, destCol); 
+
+        if (type.storage == ComponentStorage::POOL) 
+        {
+            *(uint32*) to = *(uint32*) from; 
+        }
+        else 
+        {
+            type.move(to, from); 
+        }
+
+        dest->SetChangeVersion(destRow, destCol, src->GetChangeVersion(srcRow, srcCol)); 
+    }
+
+    RemoveRow(src, srcRow); 
+
+    entity.archetype = dest; 
+    entity.row = destRow; 
+
+    return destRow; 
+}
+
+void EntityManager::RemoveRow(EntityArchetype* archetype, uint32 row) 
 {
-    return id < ids_.Size(); 
+    EntityId moved; 
+
+    if (archetype->RemoveRow(row, moved)) 
+    {
+        entities_[moved.id].row = row; 
+    }
 }
 
-int EntityManager::FindComponentIndex(uint32 entityId, ClassId compId) const  
+EntityArchetype* EntityManager::GetArchetype(const std::vector<const ComponentType*>& types) 
 {
-    auto& list = entities_[entityId].components; 
+    ComponentMask mask; 
+    for (auto type : types) 
+    {
+        SetComponentBit(mask, type->id); 
+    }
+
+    auto it = archetypeLookup_.find(mask); 
 
-    for (unsigned i = 0; i < list.size(); i++) 
+    if (it != archetypeLookup_.end()) 
     {
-        if (list[i].first == compId) return i; 
+        return it->second; 
     }
 
-    return -1; 
+    EntityArchetype* archetype = new EntityArchetype(types, mask); 
+    archetypes_.push_back(archetype); 
+    archetypeLookup_[mask] = archetype; 
+    filterCache_.OnCreateArchetype(archetype); 
+
+    return archetype; 
 }
 
-}
\ No newline at end of file
+EntityArchetype* EntityManager::GetArchetypeWith(EntityArchetype* archetype, const ComponentType& type) 
+{
+    EntityArchetype* next = archetype->GetAddEdge(type.id); 
+
+    if (!next) 
+    {
+        std::vector<const ComponentType*> types; 
+        for (uint32 i = 0; i < archetype->GetColumnCount(); i++) 
+        {
+            types.push_back(&archetype->GetColumnType(i)); 
+        }
+        types.push_back(&type); 
+
+        std::sort(types.begin(), types.end(), 
+            [](const ComponentType* a, const ComponentType* b) -> bool { 
+                return a->id < b->id; 
+            }
+        ); 
+
+        next = GetArchetype(types); 
+        archetype->SetAddEdge(type.id, next); 
+        next->SetRemoveEdge(type.id, archetype); 
+    }
+
+    return next; 
+}
+
+EntityArchetype* EntityManager::GetArchetypeWithout(EntityArchetype* archetype, ClassId compId) 
+{
+    EntityArchetype* next = archetype->GetRemoveEdge(compId); 
+
+    if (!next) 
+    {
+        std::vector<const ComponentType*> types; 
+        for (uint32 i = 0; i < archetype->GetColumnCount(); i++) 
+        {
+            if (archetype->GetTypeIds()[i] != compId) 
+            {
+                types.push_back(&archetype->GetColumnType(i)); 
+            }
+        }
+
+        next = GetArchetype(types); 
+        archetype->SetRemoveEdge(compId, next); 
+        next->SetAddEdge(compId, archetype); 
+    }
+
+    return next; 
+}
+
+ChangeVersionScope::ChangeVersionScope(const EntityManager& manager, uint32 version) 
+    : previousSerial_(writeVersion.serial), previousVersion_(writeVersion.version) 
+{
+    writeVersion.serial = manager.serial_; 
+    writeVersion.version = version; 
+}
+
+ChangeVersionScope::~ChangeVersionScope() 
+{
+    writeVersion.serial = previousSerial_; 
+    writeVersion.version = previousVersion_; 
+}
+
+}
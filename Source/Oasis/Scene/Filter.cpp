@@ -1,5 +1,6 @@
 #include "Oasis/Scene/Filter.h" 
 
+#include "Oasis/Scene/Archetype.h" 
 #include "Oasis/Scene/EntityManager.h" 
 
 namespace Oasis 
@@ -41,46 +42,31 @@ EntityFilter::EntityFilter(const std::vector<ClassId>& include, const std::vecto
     : include_(include) 
     , exclude_(exclude) {} 
 
-bool EntityFilter::Matches(const EntityManager& manager, const EntityId& id) const 
-{
-    for (auto comp : include_) 
-    {
-        if (!manager.HasComponent(id, comp)) return false; 
-    }
-
-    for (auto comp : exclude_) 
-    {
-        if (manager.HasComponent(id, comp)) return false; 
-    }
-
-    return true; 
-}
-
-bool EntityFilter::MatchesWithout(const EntityManager& manager, const EntityId& id, ClassId compId) const 
+bool EntityFilter::Matches(const EntityArchetype& archetype) const 
 {
     for (auto comp : include_) 
     {
-        if (comp != compId && !manager.HasComponent(id, comp)) return false; 
+        if (!archetype.Has(comp)) return false; 
     }
 
     for (auto comp : exclude_) 
     {
-        if (comp != compId && manager.HasComponent(id, comp)) return false; 
+        if (archetype.Has(comp)) return false; 
     }
 
     return true; 
 }
 
-bool EntityFilter::MatchesWith(const EntityManager& manager, const EntityId& id, ClassId compId) const 
+bool EntityFilter::Matches(const EntityManager& manager, const EntityId& id) const 
 {
     for (auto comp : include_) 
     {
-        if (!(comp == compId || manager.HasComponent(id, comp))) return false; 
+        if (!manager.HasComponent(id, comp)) return false; 
     }
 
     for (auto comp : exclude_) 
     {
-        if (comp == compId || manager.HasComponent(id, comp)) return false; 
+        if (manager.HasComponent(id, comp)) return false; 
     }
 
     return true; 
@@ -2,9 +2,13 @@
 
 #include "Oasis/Scene/EntityManager.h" 
 
+#include <algorithm> 
+
 namespace Oasis 
 {
 
+const uint32 EntityFilterCache::NOT_FOUND = 0xFFFFFFFF; 
+
 EntityFilterCache::EntityFilterCache(EntityManager* manager) 
     : entityManager_(manager) 
 {
@@ -13,17 +17,89 @@ EntityFilterCache::EntityFilterCache(EntityManager* manager)
 
 uint32 EntityFilterCache::GetFilterId(const EntityFilter& filter) 
 {
-    // TODO search existing entries to see if there is
-    // equivalent filter 
+    // compile the filter to masks, which also drops duplicate
+    // components and the order they were given in
+    Entry compiled(filter); 
+
+    for (auto compId : filter.GetIncludes()) 
+    {
+        SetComponentBit(compiled.include, compId); 
+    }
+
+    for (auto compId : filter.GetExcludes()) 
+    {
+        SetComponentBit(compiled.exclude, compId); 
+    }
+
+    compiled.constraints = compiled.include.count() + compiled.exclude.count(); 
+
+    // share an equivalent filter, and find the narrowest filter this
+    // one is a subset of to take its entities from
+    uint32 parent = NOT_FOUND; 
+
+    for (uint32 i = 0; i < entries_.size(); i++) 
+    {
+        Entry& e = entries_[i]; 
+
+        if (!e.count) continue; 
+
+        if (e.SameAs(compiled)) 
+        {
+            e.count++; 
+            return i; 
+        }
+
+        if (compiled.IsSubsetOf(e) && (parent == NOT_FOUND || e.constraints > entries_[parent].constraints)) 
+        {
+            parent = i; 
+        }
+    }
+
     uint32 id = ids_.Get(); 
 
     if (id >= entries_.size()) 
     {
-        entries_.push_back(Entry(filter)); 
+        entries_.push_back(compiled); 
     }
     else 
     {
-        entries_[id] = Entry(filter); 
+        entries_[id] = compiled; 
+    }
+
+    Entry& e = entries_[id]; 
+
+    // pick up entities that already exist, a subset only has to look
+    // at the archetypes of its parent
+    const std::vector<EntityArchetype*>& candidates = parent == NOT_FOUND ? 
+        entityManager_->GetArchetypes() : entries_[parent].archetypes; 
+
+    for (auto archetype : candidates) 
+    {
+        if (!e.Matches(archetype->GetMask())) continue; 
+
+        e.archetypes.push_back(archetype); 
+
+        for (uint32 row = 0; row < archetype->GetEntityCount(); row++) 
+        {
+            e.Insert(archetype->GetEntityId(row)); 
+        }
+    }
+
+    Link(id, parent); 
+
+    // filters that are subsets of the new one move under it if it is
+    // narrower than their current parent
+    for (uint32 i = 0; i < entries_.size(); i++) 
+    {
+        Entry& other = entries_[i]; 
+
+        if (!other.count || i == id || !other.IsSubsetOf(e)) continue; 
+
+        if (other.parent == NOT_FOUND || entries_[other.parent].constraints < e.constraints) 
+        {
+            Unlink(i); 
+            Link(i, id); 
+        }
     }
 
     return id; 
@@ -39,7 +115,22 @@ bool EntityFilterCache::ReleaseFilterId(uint32 id)
 
         if (e.count == 0) 
         {
+            // children are subsets of the parent too
+            std::vector<uint32> children; 
+            children.swap(e.children); 
+            uint32 parent = e.parent; 
+
+            Unlink(id); 
+
+            for (auto child : children) 
+            {
+                entries_[child].parent = NOT_FOUND; 
+                Link(child, parent); 
+            }
+
             e.entities.clear(); 
+            e.sparse.clear(); 
+            e.archetypes.clear(); 
             ids_.Release(id); 
 
             return true; 
@@ -72,202 +163,177 @@ void EntityFilterCache::GetEntities(uint32 filterId, uint32& count, const Entity
     }
 }
 
-void EntityFilterCache::Lock() 
+const std::vector<EntityArchetype*>& EntityFilterCache::GetArchetypes(uint32 filterId) const 
 {
-    lock_ = true; 
+    if (ids_.IsValid(filterId)) 
+    {
+        return entries_[filterId].archetypes; 
+    }
+    else 
+    {
+        return noArchetypes_; 
+    }
 }
 
-void EntityFilterCache::Unlock() 
+void EntityFilterCache::OnCreateArchetype(EntityArchetype* archetype) 
 {
-    lock_ = false; 
+    const ComponentMask& mask = archetype->GetMask(); 
 
-    // Logger::Debug("Buffered events: ", eventBuffer_.size()); 
-
-    for (auto& event : eventBuffer_) 
+    Visit(roots_, [&](Entry& entry) 
     {
-        switch (event.eventType) 
-        {
-        case EntityEventType::CREATE: 
-            OnCreateEntityNoLock(event.id); 
-            break; 
-        case EntityEventType::DESTROY: 
-            OnDestroyEntityNoLock(event.id); 
-            break; 
-        case EntityEventType::ADD_COMPONENT: 
-            OnAddEntityComponentNoLock(event.id, event.componentId); 
-            break; 
-        case EntityEventType::REMOVE_COMPONENT: 
-            OnRemoveEntityComponentNoLock(event.id, event.componentId); 
-            break; 
-        default: 
-            Logger::Warning("FilterCache: Unknown Event Type: ", (int) event.eventType); 
-        }
-    }
+        if (!entry.Matches(mask)) return false; 
 
-    eventBuffer_.clear(); 
+        entry.archetypes.push_back(archetype); 
+        return true; 
+    }); 
 }
 
-void EntityFilterCache::OnCreateEntity(const EntityId& id) 
+void EntityFilterCache::OnCreateEntity(const EntityId& id, const EntityArchetype* archetype) 
 {
-    // if (lock_) 
-    // {
-    //     eventBuffer_.push_back({id, EntityEventType::CREATE}); 
-    // }
-    // else 
-    // {
-        OnCreateEntityNoLock(id); 
-    // }
-}
+    const ComponentMask& mask = archetype->GetMask(); 
 
-void EntityFilterCache::OnDestroyEntity(const EntityId& id) 
-{
-    // if (lock_) 
-    // {
-    //     eventBuffer_.push_back({id, EntityEventType::DESTROY}); 
-    // }
-    // else 
-    // {
-        OnDestroyEntityNoLock(id); 
-    // }
-}
+    Visit(roots_, [&](Entry& entry) 
+    {
+        if (!entry.Matches(mask)) return false; 
 
-void EntityFilterCache::OnAddEntityComponent(const EntityId& id, ClassId compId) 
-{
-    // if (lock_) 
-    // {
-    //     eventBuffer_.push_back({id, EntityEventType::ADD_COMPONENT, compId}); 
-    // }
-    // else 
-    // {
-        OnAddEntityComponentNoLock(id, compId); 
-    // }
+        entry.Insert(id); 
+        return true; 
+    }); 
 }
 
-void EntityFilterCache::OnRemoveEntityComponent(const EntityId& id, ClassId compId) 
+void EntityFilterCache::OnDestroyEntity(const EntityId& id) 
 {
-    if (lock_) 
-    {
-        eventBuffer_.push_back({id, EntityEventType::REMOVE_COMPONENT, compId}); 
-    }
-    else 
+    Visit(roots_, [&](Entry& entry) 
     {
-        OnRemoveEntityComponentNoLock(id, compId); 
-    }
+        return entry.Erase(id); 
+    }); 
 }
 
-void EntityFilterCache::OnCreateEntityNoLock(const EntityId& id) 
+void EntityFilterCache::OnCreateEntities(const EntityId* ids, uint32 count, const EntityArchetype* archetype) 
 {
-    for (auto& entry : entries_) 
+    const ComponentMask& mask = archetype->GetMask(); 
+
+    Visit(roots_, [&](Entry& entry) 
     {
-        if (!entry.count) continue; 
+        if (!entry.Matches(mask)) return false; 
+
+        entry.entities.reserve(entry.entities.size() + count); 
 
-        if (entry.filter.Matches(*entityManager_, id)) 
+        for (uint32 i = 0; i < count; i++) 
         {
-            // Logger::Debug("FilterCache: Adding ID: ", id.id); 
-            entry.entities.push_back(id); 
+            entry.Insert(ids[i]); 
         }
-    }
+
+        return true; 
+    }); 
 }
 
-void EntityFilterCache::OnDestroyEntityNoLock(const EntityId& id) 
+void EntityFilterCache::OnDestroyEntities(const EntityId* ids, uint32 count) 
 {
-    for (auto& entry : entries_) 
+    Visit(roots_, [&](Entry& entry) 
     {
-        if (!entry.count) continue; 
+        if (entry.entities.empty()) return false; 
 
-        auto& list = entry.entities; 
+        bool erased = false; 
 
-        for (unsigned i = 0; i < list.size(); i++) 
+        for (uint32 i = 0; i < count; i++) 
         {
-            if (list[i] == id) 
-            {
-                list[i] = list.back(); 
-                list.pop_back(); 
-                break; 
-            }
+            erased |= entry.Erase(ids[i]); 
         }
-        // Logger::Debug("FilterCache: Removing ID: ", id.id); 
-    }
+
+        return erased; 
+    }); 
 }
 
-void EntityFilterCache::OnAddEntityComponentNoLock(const EntityId& id, ClassId compId) 
+void EntityFilterCache::OnChangeEntityArchetype(const EntityId& id, const EntityArchetype* from, const EntityArchetype* to) 
 {
-    for (auto& entry : entries_) 
-    {
-        if (!entry.count) continue; 
-        // TODO 
-        auto& filter = entry.filter; 
+    const ComponentMask& fromMask = from->GetMask(); 
+    const ComponentMask& toMask = to->GetMask(); 
 
-        bool match = filter.Matches(*entityManager_, id); 
+    Visit(roots_, [&](Entry& entry) 
+    {
+        bool wasMatch = entry.Matches(fromMask); 
+        bool isMatch = entry.Matches(toMask); 
 
-        if (match && filter.Includes(compId)) 
+        if (isMatch && !wasMatch) 
         {
-            // added component must be included to match filter 
-
-            // add id 
-            entry.entities.push_back(id); 
-            // Logger::Debug("FilterCache: Adding ID (Add Component): ", id.id); 
+            entry.Insert(id); 
         }
-        else if (!match && filter.MatchesWithout(*entityManager_, id, compId)) 
+        else if (wasMatch && !isMatch) 
         {
-            // added component must be excluded to match filter 
-
-            // remove id 
-            auto& list = entry.entities; 
-            for (unsigned i = 0; i < list.size(); i++) 
-            {
-                if (list[i] == id) 
-                {
-                    list[i] = list.back(); 
-                    list.pop_back(); 
-                    break; 
-                }
-            }
-            // Logger::Debug("FilterCache: Removing ID (Add Component): ", id.id); 
+            entry.Erase(id); 
         }
 
         // else do nothing, it is already either in or not in list 
-    }
+
+        // subsets can only match if this did
+        return wasMatch || isMatch; 
+    }); 
 }
 
-void EntityFilterCache::OnRemoveEntityComponentNoLock(const EntityId& id, ClassId compId) 
+void EntityFilterCache::Link(uint32 id, uint32 parent) 
 {
-    for (auto& entry : entries_) 
+    entries_[id].parent = parent; 
+
+    if (parent == NOT_FOUND) 
     {
-        if (!entry.count) continue; 
-        // TODO 
-        auto& filter = entry.filter; 
+        roots_.push_back(id); 
+    }
+    else 
+    {
+        entries_[parent].children.push_back(id); 
+    }
+}
 
-        bool match = filter.Matches(*entityManager_, id); 
+void EntityFilterCache::Unlink(uint32 id) 
+{
+    uint32 parent = entries_[id].parent; 
+    std::vector<uint32>& list = parent == NOT_FOUND ? roots_ : entries_[parent].children; 
 
-        if (match && filter.Excludes(compId)) 
-        {
-            // removed component must be excluded to match filter 
+    list.erase(std::find(list.begin(), list.end(), id)); 
+    entries_[id].parent = NOT_FOUND; 
+}
 
-            // add id
-            entry.entities.push_back(id); 
-            // Logger::Debug("FilterCache: Adding ID (Remove Component): ", id.id); 
-        }
-        else if (!match && filter.MatchesWith(*entityManager_, id, compId)) 
-        {
-            // removed component must be included to match filter 
+bool EntityFilterCache::Entry::Contains(const EntityId& id) const 
+{
+    if (id.id >= sparse.size()) return false; 
 
-            // remove id 
-            auto& list = entry.entities; 
-            for (unsigned i = 0; i < list.size(); i++) 
-            {
-                if (list[i] == id) 
-                {
-                    list[i] = list.back(); 
-                    list.pop_back(); 
-                    break; 
-                }
-            } 
-            // Logger::Debug("FilterCache: Removing ID (Remove Component): ", id.id); 
-        }
+    uint32 index = sparse[id.id]; 
 
-        // else do nothing, it is already either in or not in list 
+    return index != NOT_FOUND && entities[index] == id; 
+}
+
+void EntityFilterCache::Entry::Insert(const EntityId& id) 
+{
+    if (id.id >= sparse.size()) 
+    {
+        sparse.resize(id.id + 1, NOT_FOUND); 
+    }
+    else if (sparse[id.id] != NOT_FOUND) 
+    {
+        // slot still holds an older version of this entity, drop it first
+        EntityId stale = entities[sparse[id.id]]; 
+        Erase(stale); 
     }
+
+    sparse[id.id] = entities.size(); 
+    entities.push_back(id); 
 }
 
-}
\ No newline at end of file
+bool EntityFilterCache::Entry::Erase(const EntityId& id) 
+{
+    if (!Contains(id)) return false; 
+
+    uint32 index = sparse[id.id]; 
+    const EntityId& last = entities.back(); 
+
+    entities[index] = last; 
+    sparse[last.id] = index; 
+
+    entities.pop_back(); 
+    sparse[id.id] = NOT_FOUND; 
+
+    return true; 
+}
+
+}
@@ -0,0 +1,253 @@
+#include "Oasis/Scene/Hierarchy.h" 
+
+#include "Oasis/Core/FrameArena.h" 
+
+#include <algorithm> 
+
+namespace Oasis 
+{
+
+const int TransformHierarchySystem::PRIORITY = 100000; 
+
+TransformHierarchySystem::TransformHierarchySystem() 
+    : EntitySystem(PRIORITY) 
+{
+    Read<LocalTransform>(); 
+    Write<WorldTransform>(); 
+    Access<Parent>(ComponentAccess::READ); 
+
+    localChanged_.push_back(GetClassId<LocalTransform>()); 
+    parentChanged_.push_back(GetClassId<Parent>()); 
+}
+
+const Matrix4* TransformHierarchySystem::GetWorldMatrix(const EntityId& id) const 
+{
+    int32 index = GetIndex(id); 
+
+    return index == -1 ? nullptr : &worlds_[index]; 
+}
+
+int32 TransformHierarchySystem::GetIndex(const EntityId& id) const 
+{
+    if (id.id >= indices_.size()) return -1; 
+
+    int32 index = indices_[id.id]; 
+
+    return index != -1 && entities_[index] == id ? index : -1; 
+}
+
+void TransformHierarchySystem::OnUpdate(Scene& scene, uint32 count, const EntityId* entities, float dt) 
+{
+    (void) scene; 
+    (void) count; 
+    (void) entities; 
+    (void) dt; 
+
+    bool changed; 
+
+    if (NeedsRebuild()) 
+    {
+        Rebuild(); 
+        changed = !entities_.empty(); 
+    }
+    else 
+    {
+        changed = UpdateLocals(); 
+    }
+
+    if (!changed) return; 
+
+    UpdateWorlds(); 
+    WriteWorlds(); 
+
+    std::fill(dirty_.begin(), dirty_.end(), 0); 
+}
+
+bool TransformHierarchySystem::NeedsRebuild() 
+{
+    bool rebuild = StructureChanged(); 
+
+    if (!rebuild) 
+    {
+        // a Parent changed in place
+        QueryChanged<const Parent>(parentChanged_).ForEach([&](const Parent&) { rebuild = true; }); 
+    }
+
+    return rebuild; 
+}
+
+void TransformHierarchySystem::Rebuild() 
+{
+    // temporaries of the rebuild, the results are copied to members
+    FrameArenaScope scope; 
+    FrameVector<EntityId> ids; 
+    FrameVector<Matrix4> locals; 
+
+    Query<const LocalTransform>().ForEachEntity([&](const EntityId& id, const LocalTransform& local) 
+    {
+        ids.push_back(id); 
+        locals.push_back(local.CreateMatrix()); 
+    }); 
+
+    uint32 count = ids.size(); 
+
+    // unsorted index by entity id for now, entities_ is used to check versions
+    entities_.assign(ids.begin(), ids.end()); 
+    std::fill(indices_.begin(), indices_.end(), -1); 
+
+    for (uint32 i = 0; i < count; i++) 
+    {
+        if (ids[i].id >= indices_.size()) indices_.resize(ids[i].id + 1, -1); 
+        indices_[ids[i].id] = i; 
+    }
+
+    FrameVector<int32> parents(count, -1); 
+
+    Query<const Parent>().ForEachEntity([&](const EntityId& id, const Parent& parent) 
+    {
+        int32 index = indices_[id.id]; 
+        int32 p = GetIndex(parent.entity); 
+
+        if (p != index) parents[index] = p; 
+    }); 
+
+    // depth of each node, -2 while its chain is being walked
+    FrameVector<int32> depths(count, -1); 
+    FrameVector<int32> chain; 
+    int32 maxDepth = -1; 
+
+    for (uint32 i = 0; i < count; i++) 
+    {
+        chain.clear(); 
+
+        int32 n = i; 
+        while (n != -1 && depths[n] == -1) 
+        {
+            depths[n] = -2; 
+            chain.push_back(n); 
+            n = parents[n]; 
+        }
+
+        int32 depth; 
+
+        if (n == -1) 
+        {
+            depth = -1; 
+        }
+        else if (depths[n] == -2) 
+        {
+            Logger::Warning("TransformHierarchySystem: Parent cycle, entity ", ids[chain.back()].id, " is used as a root"); 
+
+            parents[chain.back()] = -1; 
+            depth = -1; 
+        }
+        else 
+        {
+            depth = depths[n]; 
+        }
+
+        for (uint32 k = chain.size(); k-- > 0;) 
+        {
+            depths[chain[k]] = ++depth; 
+        }
+
+        if (depth > maxDepth) maxDepth = depth; 
+    }
+
+    // counting sort by depth, keeping archetype order within a level
+    levels_.assign(maxDepth + 2, 0); 
+
+    for (uint32 i = 0; i < count; i++) 
+    {
+        levels_[depths[i] + 1]++; 
+    }
+
+    for (uint32 d = 1; d < levels_.size(); d++) 
+    {
+        levels_[d] += levels_[d - 1]; 
+    }
+
+    FrameVector<uint32> next(levels_.begin(), levels_.end() - 1); 
+    FrameVector<uint32> sorted(count); 
+
+    for (uint32 i = 0; i < count; i++) 
+    {
+        sorted[i] = next[depths[i]]++; 
+    }
+
+    entities_.resize(count); 
+    parents_.resize(count); 
+    locals_.resize(count); 
+    worlds_.resize(count); 
+    dirty_.assign(count, 1); 
+
+    for (uint32 i = 0; i < count; i++) 
+    {
+        uint32 s = sorted[i]; 
+
+        entities_[s] = ids[i]; 
+        parents_[s] = parents[i] == -1 ? -1 : sorted[parents[i]]; 
+        locals_[s] = locals[i]; 
+        indices_[ids[i].id] = s; 
+    }
+}
+
+bool TransformHierarchySystem::UpdateLocals() 
+{
+    bool changed = false; 
+
+    QueryChanged<const LocalTransform>(localChanged_).ForEachEntity([&](const EntityId& id, const LocalTransform& local) 
+    {
+        int32 index = indices_[id.id]; 
+
+        locals_[index] = local.CreateMatrix(); 
+        dirty_[index] = 1; 
+        changed = true; 
+    }); 
+
+    return changed; 
+}
+
+void TransformHierarchySystem::UpdateWorlds() 
+{
+    JobSystem* jobs = GetJobSystem(); 
+
+    // every parent is in an earlier level, so levels run in order
+    // and the nodes of one level are independent
+    for (uint32 d = 0; d + 1 < levels_.size(); d++) 
+    {
+        uint32 first = levels_[d]; 
+        uint32 count = levels_[d + 1] - first; 
+
+        ParallelFor(count, [this, first](uint32 begin, uint32 end) 
+        {
+            for (uint32 i = first + begin; i < first + end; i++) 
+            {
+                int32 p = parents_[i]; 
+
+                if (p != -1 && dirty_[p]) dirty_[i] = 1; 
+
+                if (dirty_[i]) 
+                {
+                    worlds_[i] = p == -1 ? locals_[i] : worlds_[p] * locals_[i]; 
+                }
+            }
+        }, jobs ? jobs->GetGrainSize(count, sizeof (Matrix4)) : 0); 
+    }
+}
+
+void TransformHierarchySystem::WriteWorlds() 
+{
+    Query<WorldTransform>().ParallelForEachChunk(GetJobSystem(), [this](uint32 count, const EntityId* entities, ComponentColumn<WorldTransform> worlds) 
+    {
+        for (uint32 i = 0; i < count; i++) 
+        {
+            int32 index = indices_[entities[i].id]; 
+
+            // only written rows are marked changed
+            if (dirty_[index]) worlds[i].matrix = worlds_[index]; 
+        }
+    }); 
+}
+
+}
@@ -1,9 +1,12 @@
 #include "Oasis/Scene/Scene.h" 
 
+#include "Oasis/Core/Timer.h" 
+#include "Oasis/Graphics/RenderState.h" 
 #include "Oasis/Scene/SceneManager.h" 
 #include "Oasis/Scene/System.h" 
 
 #include <algorithm> 
+#include <cmath> 
 
 namespace Oasis
 {
@@ -27,6 +30,44 @@ bool Scene::DestroyEntity(const Entity& entity)
     return entityManager_.DestroyEntityId(entity.GetId()); 
 }
 
+std::vector<Entity> Scene::CreateEntities(uint32 count, const Entity& prototype) 
+{
+    std::vector<EntityId> ids(count); 
+
+    if (!count || !entityManager_.CreateEntities(count, prototype.GetId(), &ids[0])) 
+    {
+        ids.clear(); 
+    }
+
+    return ToEntities(ids); 
+}
+
+uint32 Scene::DestroyEntities(const std::vector<Entity>& entities) 
+{
+    std::vector<EntityId> ids; 
+    ids.reserve(entities.size()); 
+
+    for (auto& entity : entities) 
+    {
+        ids.push_back(entity.GetId()); 
+    }
+
+    return ids.empty() ? 0 : entityManager_.DestroyEntities(&ids[0], ids.size()); 
+}
+
+std::vector<Entity> Scene::ToEntities(const std::vector<EntityId>& ids) 
+{
+    std::vector<Entity> entities; 
+    entities.reserve(ids.size()); 
+
+    for (auto& id : ids) 
+    {
+        entities.push_back(Entity(&entityManager_, id)); 
+    }
+
+    return entities; 
+}
+
 void Scene::AddSystem(EntitySystem* system, bool autoDelete) 
 {
     systemManager_.AddSystem(system, autoDelete); 
@@ -47,4 +88,54 @@ void Scene::Render()
     systemManager_.Render(); 
 }
 
+void Scene::Extract(RenderState& state) 
+{
+    state.Begin(this); 
+    systemManager_.Extract(state); 
+}
+
+void Scene::Draw(const RenderState& state) 
+{
+    for (auto system : state.GetSystems()) 
+    {
+        system->Draw(state); 
+    }
+}
+
+void Scene::Simulate(float dt) 
+{
+    Timer timer; 
+    timer.Start(); 
+
+    if (timeStep_ <= 0) 
+    {
+        Update(dt); 
+        tickCount_++; 
+    }
+    else 
+    {
+        accumulator_ += dt; 
+
+        while (accumulator_ >= timeStep_) 
+        {
+            Update(timeStep_); 
+            tickCount_++; 
+            accumulator_ -= timeStep_; 
+
+            // at least one step is taken, so a slow scene still advances
+            if (tickBudget_ > 0 && timer.GetSeconds() >= tickBudget_) 
+            {
+                // behind, drop the backlog instead of falling further behind
+                double dropped = std::floor(accumulator_ / timeStep_); 
+
+                droppedTickCount_ += (uint64) dropped; 
+                accumulator_ -= dropped * timeStep_; 
+                break; 
+            }
+        }
+    }
+
+    simulateSeconds_ = timer.GetSeconds(); 
+}
+
 }
\ No newline at end of file
@@ -1,13 +1,19 @@
 #include "Oasis/Scene/SceneManager.h" 
 
+#include "Oasis/Core/JobSystem.h" 
 #include "Oasis/Scene/Scene.h" 
+#include "Oasis/Scene/System.h" 
 
 namespace Oasis 
 {
 
 SceneManager::SceneManager() {}
 
-SceneManager::~SceneManager() {} 
+SceneManager::~SceneManager() 
+{
+    deferDeletes_ = false; 
+    DeleteRetired(); 
+} 
 
 bool SceneManager::IsValidScene(Scene* scene) const 
 {
@@ -75,11 +81,88 @@ bool SceneManager::UnloadScene(Scene* scene)
     if (!IsValidScene(scene)) return false; 
 
     scenes_[scene->GetIndex()] = nullptr; 
+    if (active_ == scene) active_ = nullptr; 
+
+    if (deferDeletes_) 
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex_); 
+        retiredScenes_.push_back(scene); 
+    }
+    else 
+    {
+        delete scene; 
+    }
 
-    delete scene; 
     return true; 
 }
 
+void SceneManager::RetireSystem(EntitySystem* system) 
+{
+    if (deferDeletes_) 
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex_); 
+        retiredSystems_.push_back(system); 
+    }
+    else 
+    {
+        delete system; 
+    }
+}
+
+void SceneManager::DeleteRetired() 
+{
+    std::vector<EntitySystem*> systems; 
+    std::vector<Scene*> scenes; 
+
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex_); 
+        systems.swap(retiredSystems_); 
+        scenes.swap(retiredScenes_); 
+    }
+
+    // systems first, they may still refer to their scene
+    for (auto system : systems) 
+    {
+        delete system; 
+    }
+
+    for (auto scene : scenes) 
+    {
+        delete scene; 
+    }
+}
+
+void SceneManager::Simulate(float dt) 
+{
+    simulated_.clear(); 
+
+    for (auto scene : scenes_) 
+    {
+        if (scene && scene->IsSimulated()) simulated_.push_back(scene); 
+    }
+
+    if (!jobSystem_ || simulated_.size() < 2) 
+    {
+        for (auto scene : simulated_) 
+        {
+            scene->Simulate(dt); 
+        }
+
+        return; 
+    }
+
+    // scene updates wait on their own system jobs, the
+    // waiting thread runs other jobs in the meantime
+    JobCounter counter; 
+
+    for (auto scene : simulated_) 
+    {
+        jobSystem_->Schedule([scene, dt]() { scene->Simulate(dt); }, &counter); 
+    }
+
+    jobSystem_->Wait(counter); 
+}
+
 Scene* SceneManager::GetSceneByIndex(int index) 
 {
     return scenes_[index]; 
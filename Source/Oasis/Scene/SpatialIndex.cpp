@@ -0,0 +1,631 @@
+#include "Oasis/Scene/SpatialIndex.h" 
+
+#include <algorithm> 
+
+namespace Oasis 
+{
+
+const uint32 AabbTree::NONE = 0xFFFFFFFF; 
+
+AabbTree::AabbTree() 
+    : root_(NONE) 
+    , free_(NONE) 
+    , leafCount_(0) 
+    , margin_(0.1f) 
+{
+
+}
+
+uint32 AabbTree::Insert(const Aabb& box, uint32 data) 
+{
+    uint32 leaf = Add(box, data); 
+
+    InsertLeaf(leaf); 
+
+    return leaf; 
+}
+
+uint32 AabbTree::Add(const Aabb& box, uint32 data) 
+{
+    uint32 leaf = AllocateNode(); 
+
+    Node& node = nodes_[leaf]; 
+    node.box = Enlarge(box, Vector3::ZERO); 
+    node.height = 0; 
+    node.data = data; 
+
+    leafCount_++; 
+
+    return leaf; 
+}
+
+void AabbTree::Remove(uint32 leaf) 
+{
+    RemoveLeaf(leaf); 
+    FreeNode(leaf); 
+    leafCount_--; 
+}
+
+bool AabbTree::Move(uint32 leaf, const Aabb& box, const Vector3& displacement) 
+{
+    if (!NeedsMove(leaf, box)) return false; 
+
+    RemoveLeaf(leaf); 
+    nodes_[leaf].box = Enlarge(box, displacement); 
+    InsertLeaf(leaf); 
+
+    return true; 
+}
+
+void AabbTree::SetBox(uint32 leaf, const Aabb& box, const Vector3& displacement) 
+{
+    nodes_[leaf].box = Enlarge(box, displacement); 
+}
+
+void AabbTree::Rebuild() 
+{
+    build_.clear(); 
+
+    for (uint32 i = 0; i < nodes_.size(); i++) 
+    {
+        Node& node = nodes_[i]; 
+
+        if (node.height < 0) continue; 
+
+        if (node.IsLeaf()) 
+        {
+            build_.push_back({ node.box.Center(), i }); 
+        }
+        else 
+        {
+            FreeNode(i); 
+        }
+    }
+
+    root_ = build_.empty() ? NONE : Build(0, build_.size()); 
+
+    if (root_ != NONE) nodes_[root_].parent = NONE; 
+}
+
+void AabbTree::Clear() 
+{
+    nodes_.clear(); 
+    root_ = NONE; 
+    free_ = NONE; 
+    leafCount_ = 0; 
+}
+
+Vector3 AabbTree::InverseDirection(const Vector3& direction) 
+{
+    Vector3 inv; 
+
+    for (int i = 0; i < 3; i++) 
+    {
+        float d = direction[i]; 
+
+        // keeps 0 * inverse from becoming NaN in the slab test
+        if (d > -1e-20f && d < 1e-20f) d = d < 0 ? -1e-20f : 1e-20f; 
+
+        inv[i] = 1 / d; 
+    }
+
+    return inv; 
+}
+
+Aabb AabbTree::Enlarge(const Aabb& box, const Vector3& displacement) const 
+{
+    Aabb out = box.Expanded(Vector3(margin_)); 
+
+    // expect the leaf to keep moving the same way
+    for (int i = 0; i < 3; i++) 
+    {
+        float d = displacement[i] * 2; 
+
+        if (d < 0) out.min[i] += d; 
+        else out.max[i] += d; 
+    }
+
+    return out; 
+}
+
+uint32 AabbTree::AllocateNode() 
+{
+    uint32 index; 
+
+    if (free_ != NONE) 
+    {
+        index = free_; 
+        free_ = nodes_[index].parent; 
+        nodes_[index] = Node(); 
+    }
+    else 
+    {
+        index = nodes_.size(); 
+        nodes_.push_back(Node()); 
+    }
+
+    return index; 
+}
+
+void AabbTree::FreeNode(uint32 node) 
+{
+    nodes_[node].height = -1; 
+    nodes_[node].parent = free_; 
+    free_ = node; 
+}
+
+void AabbTree::InsertLeaf(uint32 leaf) 
+{
+    if (root_ == NONE) 
+    {
+        root_ = leaf; 
+        nodes_[leaf].parent = NONE; 
+        return; 
+    }
+
+    // find the sibling that grows the total surface area the least
+    Aabb box = nodes_[leaf].box; 
+    uint32 index = root_; 
+
+    while (!nodes_[index].IsLeaf()) 
+    {
+        const Node& node = nodes_[index]; 
+
+        float area = node.box.SurfaceArea(); 
+        float combinedArea = Aabb::Merge(node.box, box).SurfaceArea(); 
+
+        // making a new parent for this node and the leaf
+        float cost = 2 * combinedArea; 
+
+        // pushing the leaf further down grows every node on the way
+        float inheritedCost = 2 * (combinedArea - area); 
+
+        float childCost[2]; 
+        uint32 children[2] = { node.child1, node.child2 }; 
+
+        for (int i = 0; i < 2; i++) 
+        {
+            const Node& child = nodes_[children[i]]; 
+            float merged = Aabb::Merge(child.box, box).SurfaceArea(); 
+
+            childCost[i] = (child.IsLeaf() ? merged : merged - child.box.SurfaceArea()) + inheritedCost; 
+        }
+
+        if (cost < childCost[0] && cost < childCost[1]) break; 
+
+        index = childCost[0] < childCost[1] ? children[0] : children[1]; 
+    }
+
+    uint32 sibling = index; 
+    uint32 oldParent = nodes_[sibling].parent; 
+    uint32 newParent = AllocateNode(); 
+
+    Node& parent = nodes_[newParent]; 
+    parent.parent = oldParent; 
+    parent.box = Aabb::Merge(box, nodes_[sibling].box); 
+    parent.height = nodes_[sibling].height + 1; 
+    parent.child1 = sibling; 
+    parent.child2 = leaf; 
+
+    if (oldParent != NONE) 
+    {
+        if (nodes_[oldParent].child1 == sibling) nodes_[oldParent].child1 = newParent; 
+        else nodes_[oldParent].child2 = newParent; 
+    }
+    else 
+    {
+        root_ = newParent; 
+    }
+
+    nodes_[sibling].parent = newParent; 
+    nodes_[leaf].parent = newParent; 
+
+    // fix heights and boxes on the way up
+    index = newParent; 
+
+    while (index != NONE) 
+    {
+        index = Balance(index); 
+
+        Node& node = nodes_[index]; 
+        node.height = 1 + std::max(nodes_[node.child1].height, nodes_[node.child2].height); 
+        node.box = Aabb::Merge(nodes_[node.child1].box, nodes_[node.child2].box); 
+
+        index = node.parent; 
+    }
+}
+
+void AabbTree::RemoveLeaf(uint32 leaf) 
+{
+    if (leaf == root_) 
+    {
+        root_ = NONE; 
+        return; 
+    }
+
+    uint32 parent = nodes_[leaf].parent; 
+    uint32 grandParent = nodes_[parent].parent; 
+    uint32 sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1; 
+
+    FreeNode(parent); 
+    nodes_[sibling].parent = grandParent; 
+
+    if (grandParent == NONE) 
+    {
+        root_ = sibling; 
+        return; 
+    }
+
+    if (nodes_[grandParent].child1 == parent) nodes_[grandParent].child1 = sibling; 
+    else nodes_[grandParent].child2 = sibling; 
+
+    uint32 index = grandParent; 
+
+    while (index != NONE) 
+    {
+        index = Balance(index); 
+
+        Node& node = nodes_[index]; 
+        node.height = 1 + std::max(nodes_[node.child1].height, nodes_[node.child2].height); 
+        node.box = Aabb::Merge(nodes_[node.child1].box, nodes_[node.child2].box); 
+
+        index = node.parent; 
+    }
+}
+
+uint32 AabbTree::Balance(uint32 iA) 
+{
+    Node& a = nodes_[iA]; 
+
+    if (a.IsLeaf() || a.height < 2) return iA; 
+
+    uint32 iB = a.child1; 
+    uint32 iC = a.child2; 
+    Node& b = nodes_[iB]; 
+    Node& c = nodes_[iC]; 
+
+    int32 balance = c.height - b.height; 
+
+    if (balance > 1) 
+    {
+        // C takes the place of A
+        uint32 iF = c.child1; 
+        uint32 iG = c.child2; 
+        Node& f = nodes_[iF]; 
+        Node& g = nodes_[iG]; 
+
+        c.child1 = iA; 
+        c.parent = a.parent; 
+        a.parent = iC; 
+
+        if (c.parent == NONE) root_ = iC; 
+        else if (nodes_[c.parent].child1 == iA) nodes_[c.parent].child1 = iC; 
+        else nodes_[c.parent].child2 = iC; 
+
+        // the taller of F and G stays under C
+        if (f.height > g.height) 
+        {
+            c.child2 = iF; 
+            a.child2 = iG; 
+            g.parent = iA; 
+            a.box = Aabb::Merge(b.box, g.box); 
+            c.box = Aabb::Merge(a.box, f.box); 
+            a.height = 1 + std::max(b.height, g.height); 
+            c.height = 1 + std::max(a.height, f.height); 
+        }
+        else 
+        {
+            c.child2 = iG; 
+            a.child2 = iF; 
+            f.parent = iA; 
+            a.box = Aabb::Merge(b.box, f.box); 
+            c.box = Aabb::Merge(a.box, g.box); 
+            a.height = 1 + std::max(b.height, f.height); 
+            c.height = 1 + std::max(a.height, g.height); 
+        }
+
+        return iC; 
+    }
+
+    if (balance < -1) 
+    {
+        // B takes the place of A
+        uint32 iD = b.child1; 
+        uint32 iE = b.child2; 
+        Node& d = nodes_[iD]; 
+        Node& e = nodes_[iE]; 
+
+        b.child1 = iA; 
+        b.parent = a.parent; 
+        a.parent = iB; 
+
+        if (b.parent == NONE) root_ = iB; 
+        else if (nodes_[b.parent].child1 == iA) nodes_[b.parent].child1 = iB; 
+        else nodes_[b.parent].child2 = iB; 
+
+        if (d.height > e.height) 
+        {
+            b.child2 = iD; 
+            a.child1 = iE; 
+            e.parent = iA; 
+            a.box = Aabb::Merge(c.box, e.box); 
+            b.box = Aabb::Merge(a.box, d.box); 
+            a.height = 1 + std::max(c.height, e.height); 
+            b.height = 1 + std::max(a.height, d.height); 
+        }
+        else 
+        {
+            b.child2 = iE; 
+            a.child1 = iD; 
+            d.parent = iA; 
+            a.box = Aabb::Merge(c.box, d.box); 
+            b.box = Aabb::Merge(a.box, e.box); 
+            a.height = 1 + std::max(c.height, d.height); 
+            b.height = 1 + std::max(a.height, e.height); 
+        }
+
+        return iB; 
+    }
+
+    return iA; 
+}
+
+uint32 AabbTree::Build(uint32 begin, uint32 end) 
+{
+    if (end - begin == 1) return build_[begin].leaf; 
+
+    // split at the median center along the widest axis of the centers
+    Vector3 lo = build_[begin].center; 
+    Vector3 hi = lo; 
+
+    for (uint32 i = begin + 1; i < end; i++) 
+    {
+        const Vector3& center = build_[i].center; 
+
+        for (int k = 0; k < 3; k++) 
+        {
+            lo[k] = std::min(lo[k], center[k]); 
+            hi[k] = std::max(hi[k], center[k]); 
+        }
+    }
+
+    Vector3 size = hi - lo; 
+    int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2); 
+    uint32 mid = begin + (end - begin) / 2; 
+
+    std::nth_element(build_.begin() + begin, build_.begin() + mid, build_.begin() + end, [axis](const BuildLeaf& l, const BuildLeaf& r) 
+    {
+        return l.center[axis] < r.center[axis]; 
+    }); 
+
+    uint32 child1 = Build(begin, mid); 
+    uint32 child2 = Build(mid, end); 
+
+    // children are built first, so no node is allocated while this one is in use
+    uint32 index = AllocateNode(); 
+    Node& node = nodes_[index]; 
+    node.child1 = child1; 
+    node.child2 = child2; 
+    node.box = Aabb::Merge(nodes_[child1].box, nodes_[child2].box); 
+    node.height = 1 + std::max(nodes_[child1].height, nodes_[child2].height); 
+
+    nodes_[child1].parent = index; 
+    nodes_[child2].parent = index; 
+
+    return index; 
+}
+
+const int SpatialIndexSystem::PRIORITY = 100100; 
+const float SpatialIndexSystem::REBUILD_FRACTION = 0.15f; 
+
+SpatialIndexSystem::SpatialIndexSystem() 
+    : EntitySystem(PRIORITY) 
+{
+    Read<WorldTransform>(); 
+    Read<SpatialBounds>(); 
+
+    changed_.push_back(GetClassId<WorldTransform>()); 
+    changed_.push_back(GetClassId<SpatialBounds>()); 
+}
+
+const Aabb* SpatialIndexSystem::GetBox(const EntityId& id) const 
+{
+    int32 slot = GetSlot(id); 
+
+    return slot == -1 ? nullptr : &boxes_[slot]; 
+}
+
+bool SpatialIndexSystem::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance, EntityId& hit, float& distance) const 
+{
+    Vector3 inv = AabbTree::InverseDirection(direction); 
+    int32 closest = -1; 
+
+    tree_.Raycast(origin, direction, maxDistance, [&](uint32 slot, float max) -> float 
+    {
+        float d = boxes_[slot].Intersect(origin, inv, max); 
+
+        if (d < 0) return max; 
+
+        closest = slot; 
+        return d; 
+    }); 
+
+    if (closest == -1) return false; 
+
+    hit = entities_[closest]; 
+    distance = boxes_[closest].Intersect(origin, inv, maxDistance); 
+
+    return true; 
+}
+
+void SpatialIndexSystem::OnUpdate(Scene& scene, uint32 count, const EntityId* entities, float dt) 
+{
+    (void) scene; 
+    (void) count; 
+    (void) entities; 
+    (void) dt; 
+
+    if (StructureChanged()) 
+    {
+        Sync(); 
+    }
+    else 
+    {
+        Refit(); 
+    }
+
+    Flush(); 
+}
+
+void SpatialIndexSystem::Sync() 
+{
+    stamp_++; 
+
+    Query<const WorldTransform, const SpatialBounds>().ForEachEntity([&](const EntityId& id, const WorldTransform& world, const SpatialBounds& bounds) 
+    {
+        int32 slot = GetSlot(id); 
+        Aabb box = GetBox(world, bounds); 
+
+        if (slot == -1) 
+        {
+            added_.push_back(id); 
+            addedBoxes_.push_back(box); 
+        }
+        else 
+        {
+            Update(slot, box); 
+            seen_[slot] = stamp_; 
+        }
+    }); 
+
+    // escaped_ holds leaves, so slots can change here
+    for (uint32 slot = entities_.size(); slot-- > 0;) 
+    {
+        if (seen_[slot] != stamp_) Remove(slot); 
+    }
+
+    for (uint32 i = 0; i < added_.size(); i++) 
+    {
+        Add(added_[i], addedBoxes_[i]); 
+    }
+
+    added_.clear(); 
+    addedBoxes_.clear(); 
+}
+
+void SpatialIndexSystem::Refit() 
+{
+    QueryChanged<const WorldTransform, const SpatialBounds>(changed_).ForEachEntity([&](const EntityId& id, const WorldTransform& world, const SpatialBounds& bounds) 
+    {
+        Update(GetSlot(id), GetBox(world, bounds)); 
+    }); 
+}
+
+bool SpatialIndexSystem::Update(uint32 slot, const Aabb& box) 
+{
+    Vector3 displacement = box.Center() - boxes_[slot].Center(); 
+    boxes_[slot] = box; 
+
+    if (!tree_.NeedsMove(leaves_[slot], box)) return false; 
+
+    escaped_.push_back(leaves_[slot]); 
+    displacements_.push_back(displacement); 
+
+    return true; 
+}
+
+void SpatialIndexSystem::Add(const EntityId& id, const Aabb& box) 
+{
+    uint32 slot = entities_.size(); 
+
+    entities_.push_back(id); 
+    boxes_.push_back(box); 
+    leaves_.push_back(AabbTree::NONE); 
+    seen_.push_back(stamp_); 
+
+    if (id.id >= slots_.size()) slots_.resize(id.id + 1, -1); 
+    slots_[id.id] = slot; 
+}
+
+void SpatialIndexSystem::Remove(uint32 slot) 
+{
+    uint32 last = entities_.size() - 1; 
+
+    tree_.Remove(leaves_[slot]); 
+    slots_[entities_[slot].id] = -1; 
+
+    if (slot != last) 
+    {
+        entities_[slot] = entities_[last]; 
+        boxes_[slot] = boxes_[last]; 
+        leaves_[slot] = leaves_[last]; 
+        seen_[slot] = seen_[last]; 
+
+        tree_.SetData(leaves_[slot], slot); 
+        slots_[entities_[slot].id] = slot; 
+    }
+
+    entities_.pop_back(); 
+    boxes_.pop_back(); 
+    leaves_.pop_back(); 
+    seen_.pop_back(); 
+}
+
+void SpatialIndexSystem::Flush() 
+{
+    uint32 count = escaped_.size(); 
+
+    // added slots come last and have no leaf yet
+    uint32 firstAdded = tree_.GetLeafCount(); 
+    uint32 added = entities_.size() - firstAdded; 
+
+    if (count + added > entities_.size() * REBUILD_FRACTION) 
+    {
+        for (uint32 i = 0; i < count; i++) 
+        {
+            uint32 leaf = escaped_[i]; 
+            tree_.SetBox(leaf, boxes_[tree_.GetData(leaf)], displacements_[i]); 
+        }
+
+        for (uint32 slot = firstAdded; slot < entities_.size(); slot++) 
+        {
+            leaves_[slot] = tree_.Add(boxes_[slot], slot); 
+        }
+
+        tree_.Rebuild(); 
+    }
+    else 
+    {
+        for (uint32 i = 0; i < count; i++) 
+        {
+            uint32 leaf = escaped_[i]; 
+            tree_.Move(leaf, boxes_[tree_.GetData(leaf)], displacements_[i]); 
+        }
+
+        for (uint32 slot = firstAdded; slot < entities_.size(); slot++) 
+        {
+            leaves_[slot] = tree_.Insert(boxes_[slot], slot); 
+        }
+    }
+
+    escaped_.clear(); 
+    displacements_.clear(); 
+}
+
+int32 SpatialIndexSystem::GetSlot(const EntityId& id) const 
+{
+    if (id.id >= slots_.size()) return -1; 
+
+    int32 slot = slots_[id.id]; 
+
+    return slot != -1 && entities_[slot] == id ? slot : -1; 
+}
+
+Aabb SpatialIndexSystem::GetBox(const WorldTransform& world, const SpatialBounds& bounds) 
+{
+    const Matrix4& m = world.matrix; 
+
+    return Aabb::FromCenter(Vector3(m.m03, m.m13, m.m23), bounds.extents); 
+}
+
+}
@@ -1,6 +1,13 @@
 #include "Oasis/Scene/System.h" 
 
+#include "Oasis/Core/Profiler.h" 
+#include "Oasis/Core/TimeUtil.h" 
+#include "Oasis/Graphics/RenderState.h" 
 #include "Oasis/Scene/Scene.h" 
+#include "Oasis/Scene/SceneManager.h" 
+
+#include <algorithm> 
+#include <typeinfo> 
 
 namespace Oasis 
 {
@@ -31,19 +38,151 @@ void EntitySystem::OnRender(Scene& scene, uint32 count, const EntityId* entities
     (void) entities; 
 }
 
+void EntitySystem::OnExtract(Scene& scene, uint32 count, const EntityId* entities, RenderState& state) 
+{
+    (void) scene; 
+    (void) count; 
+    (void) entities; 
+    (void) state; 
+}
+
+void EntitySystem::OnDraw(const RenderState& state) 
+{
+    (void) state; 
+}
+
+void EntitySystem::SetName(const std::string& name) 
+{
+    name_ = name; 
+
+    updateZone_ = Profiler::Intern(name + "::Update"); 
+    renderZone_ = Profiler::Intern(name + "::Render"); 
+    extractZone_ = Profiler::Intern(name + "::Extract"); 
+    drawZone_ = Profiler::Intern(name + "::Draw"); 
+}
+
+JobSystem* EntitySystem::GetJobSystem() 
+{
+    return scene_ ? scene_->GetSceneManager().GetJobSystem() : nullptr; 
+}
+
+void EntitySystem::ParallelFor(uint32 count, const JobSystem::RangeJob& fn, uint32 grainSize) 
+{
+    JobSystem* jobs = GetJobSystem(); 
+
+    if (jobs) 
+    {
+        // ranges of the entity id array
+        if (!grainSize) grainSize = jobs->GetGrainSize(count, sizeof (EntityId)); 
+
+        // jobs run on other threads, writes still belong to this run
+        uint32 version = changeVersion_ ? changeVersion_ : GetEntityManager().GetChangeVersion(); 
+
+        jobs->ParallelFor(count, [this, version, &fn](uint32 begin, uint32 end) 
+        {
+            ChangeVersionScope scope(GetEntityManager(), version); 
+            fn(begin, end); 
+        }, grainSize); 
+    }
+    else if (count) 
+    {
+        fn(0, count); 
+    }
+}
+
+EntityManager& EntitySystem::GetEntityManager() 
+{
+    return scene_->GetEntityManager(); 
+}
+
+EntityCommandBuffer& EntitySystem::GetCommandBuffer() 
+{
+    return scene_->GetEntityManager().GetCommandBuffer(); 
+}
+
+const std::vector<EntityArchetype*>& EntitySystem::GetArchetypes() const 
+{
+    return scene_->GetEntityManager().GetFilterCache().GetArchetypes(filterId_); 
+}
+
+bool EntitySystem::StructureChanged() 
+{
+    const std::vector<EntityArchetype*>& archetypes = GetArchetypes(); 
+
+    // versions only grow, so the sum changes with any added or removed row
+    uint64 version = 0; 
+    for (auto archetype : archetypes) 
+    {
+        version += archetype->GetStructureVersion(); 
+    }
+
+    bool changed = version != structureVersion_ || archetypes.size() != archetypeCount_; 
+
+    structureVersion_ = version; 
+    archetypeCount_ = archetypes.size(); 
+
+    return changed; 
+}
+
+void EntitySystem::DeclareAccess(ClassId compId, ComponentAccess access) 
+{
+    declaresAccess_ = true; 
+
+    std::vector<ClassId>& list = access == ComponentAccess::WRITE ? writes_ : reads_; 
+
+    if (std::find(list.begin(), list.end(), compId) == list.end()) 
+    {
+        list.push_back(compId); 
+    }
+}
+
+static bool ContainsAny(const std::vector<ClassId>& a, const std::vector<ClassId>& b) 
+{
+    for (auto id : a) 
+    {
+        if (std::find(b.begin(), b.end(), id) != b.end()) return true; 
+    }
+
+    return false; 
+}
+
+bool EntitySystem::ConflictsWith(const EntitySystem& other) const 
+{
+    if (!declaresAccess_ || !other.declaresAccess_) return true; 
+
+    return ContainsAny(writes_, other.reads_) || 
+           ContainsAny(writes_, other.writes_) || 
+           ContainsAny(other.writes_, reads_); 
+}
+
 void EntitySystem::Update(float dt) 
 {
     if (scene_) 
     {
+        OASIS_PROFILE_ZONE(updateZone_); 
+        uint64 start = Time::Nanos(); 
+
         EntityManager& em = scene_->GetEntityManager(); 
         EntityFilterCache& fc = em.GetFilterCache(); 
         uint32 count; 
         const EntityId* entities; 
         fc.GetEntities(filterId_, count, entities); 
         
-        fc.Lock(); 
-        OnUpdate(*scene_, count, entities, dt); 
-        fc.Unlock(); 
+        changeVersion_ = em.NextChangeVersion(); 
+        changedSince_ = lastUpdateVersion_; 
+
+        // structural changes are deferred until the system is done
+        em.Lock(); 
+        {
+            ChangeVersionScope scope(em, changeVersion_); 
+            OnUpdate(*scene_, count, entities, dt); 
+        }
+        em.Unlock(); 
+
+        updateTime_.Add((Time::Nanos() - start) / 1e9); 
+
+        lastUpdateVersion_ = changeVersion_; 
+        changeVersion_ = changedSince_ = 0; 
     }
 }
 
@@ -51,18 +190,72 @@ void EntitySystem::Render()
 {
     if (scene_) 
     {
+        OASIS_PROFILE_ZONE(renderZone_); 
+        uint64 start = Time::Nanos(); 
+
         EntityManager& em = scene_->GetEntityManager(); 
         EntityFilterCache& fc = em.GetFilterCache(); 
         uint32 count; 
         const EntityId* entities; 
         fc.GetEntities(filterId_, count, entities); 
         
-        fc.Lock(); 
-        OnRender(*scene_, count, entities); 
-        fc.Unlock(); 
+        changeVersion_ = em.NextChangeVersion(); 
+        changedSince_ = lastRenderVersion_; 
+
+        em.Lock(); 
+        {
+            ChangeVersionScope scope(em, changeVersion_); 
+            OnRender(*scene_, count, entities); 
+        }
+        em.Unlock(); 
+
+        renderTime_.Add((Time::Nanos() - start) / 1e9); 
+
+        lastRenderVersion_ = changeVersion_; 
+        changeVersion_ = changedSince_ = 0; 
     }
 }
 
+void EntitySystem::Extract(RenderState& state) 
+{
+    if (scene_) 
+    {
+        OASIS_PROFILE_ZONE(extractZone_); 
+
+        EntityManager& em = scene_->GetEntityManager(); 
+        EntityFilterCache& fc = em.GetFilterCache(); 
+        uint32 count; 
+        const EntityId* entities; 
+        fc.GetEntities(filterId_, count, entities); 
+
+        // takes the place of rendering, so Changed queries compare against it
+        changeVersion_ = em.NextChangeVersion(); 
+        changedSince_ = lastRenderVersion_; 
+
+        em.Lock(); 
+        {
+            ChangeVersionScope scope(em, changeVersion_); 
+            OnExtract(*scene_, count, entities, state); 
+        }
+        em.Unlock(); 
+
+        lastRenderVersion_ = changeVersion_; 
+        changeVersion_ = changedSince_ = 0; 
+
+        state.AddSystem(this); 
+    }
+}
+
+void EntitySystem::Draw(const RenderState& state) 
+{
+    OASIS_PROFILE_ZONE(drawZone_); 
+    uint64 start = Time::Nanos(); 
+
+    OnDraw(state); 
+
+    renderTime_.Add((Time::Nanos() - start) / 1e9); 
+}
+
 void EntitySystem::SetScene(Scene* newScene) 
 {
     if (newScene) 
@@ -75,6 +268,11 @@ void EntitySystem::SetScene(Scene* newScene)
         }
 
         scene_ = newScene; 
+        if (name_.empty()) SetName(GetTypeName(typeid(*this))); 
+
+        lastUpdateVersion_ = lastRenderVersion_ = 0; 
+        structureVersion_ = 0; 
+        archetypeCount_ = 0; 
         filterId_ = scene_->GetEntityManager().GetFilterCache().GetFilterId(filter_); 
         OnAdded(); 
     }
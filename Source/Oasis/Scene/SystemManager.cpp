@@ -1,6 +1,8 @@
 #include "Oasis/Scene/SystemManager.h" 
 
+#include "Oasis/Core/JobSystem.h" 
 #include "Oasis/Scene/Scene.h" 
+#include "Oasis/Scene/SceneManager.h" 
 #include "Oasis/Scene/System.h" 
 
 #include <algorithm> 
@@ -71,15 +73,17 @@ bool EntitySystemManager::SortSystems()
     if (sorted_) return false; 
 
     // remove systems that are flagged 
-    for (unsigned i = 0; i < systems_.size(); i++) 
+    for (unsigned i = 0; i < systems_.size(); ) 
     {
         Entry& e = systems_[i]; 
         if (e.removeFlag) 
         {
-            if (e.autoDelete) delete e.system; 
+            // a pipelined frame may still be drawing it
+            if (e.autoDelete) scene_.GetSceneManager().RetireSystem(e.system); 
 
             systems_.erase(systems_.begin() + i); 
         }
+        else i++; 
     }
 
     // sort list for any new systems added 
@@ -92,13 +96,90 @@ bool EntitySystemManager::SortSystems()
         }
     ); 
 
+    sorted_ = true; 
+    BuildBatches(); 
+
     return true; 
 }
 
+void EntitySystemManager::BuildBatches() 
+{
+    batches_.clear(); 
+
+    // a system goes in the batch after the last earlier system it
+    // conflicts with, so conflicting systems keep their priority order
+    std::vector<uint32> batchOf(systems_.size()); 
+
+    for (uint32 i = 0; i < systems_.size(); i++) 
+    {
+        uint32 batch = 0; 
+
+        for (uint32 j = 0; j < i; j++) 
+        {
+            if (batchOf[j] >= batch && systems_[i].system->ConflictsWith(*systems_[j].system)) 
+            {
+                batch = batchOf[j] + 1; 
+            }
+        }
+
+        batchOf[i] = batch; 
+
+        if (batch >= batches_.size()) batches_.resize(batch + 1); 
+        batches_[batch].push_back(i); 
+    }
+}
+
 void EntitySystemManager::Update(float dt) 
 {
     SortSystems(); 
 
+    JobSystem* jobs = scene_.GetSceneManager().GetJobSystem(); 
+
+    // batches are only rebuilt by the next update, so
+    // systems added meanwhile are not run yet
+
+    for (auto& batch : batches_) 
+    {
+        run_.clear(); 
+
+        for (auto index : batch) 
+        {
+            Entry& e = systems_[index]; 
+
+            if (e.enabled && !e.removeFlag) 
+            {
+                run_.push_back(e.system); 
+            }
+        }
+
+        if (!jobs || run_.size() <= 1) 
+        {
+            for (auto system : run_) 
+            {
+                system->Update(dt); 
+            }
+        }
+        else 
+        {
+            // hold the lock so every system's changes are applied together
+            entityManager_.Lock(); 
+
+            JobCounter counter; 
+            for (auto system : run_) 
+            {
+                jobs->Schedule([system, dt]() { system->Update(dt); }, &counter); 
+            }
+            jobs->Wait(counter); 
+
+            entityManager_.Unlock(); 
+        }
+    }
+}
+
+void EntitySystemManager::Render() 
+{
+    SortSystems(); 
+
     // use this in case any systems are added 
     unsigned startSize = systems_.size(); 
 
@@ -108,16 +189,15 @@ void EntitySystemManager::Update(float dt)
 
         if (e.enabled && !e.removeFlag) 
         {
-            e.system->Update(dt); 
+            e.system->Render();  
         }
     }
 }
 
-void EntitySystemManager::Render() 
+void EntitySystemManager::Extract(RenderState& state) 
 {
     SortSystems(); 
 
-    // use this in case any systems are added 
     unsigned startSize = systems_.size(); 
 
     for (unsigned i = 0; i < startSize; i++) 
@@ -126,7 +206,7 @@ void EntitySystemManager::Render()
 
         if (e.enabled && !e.removeFlag) 
         {
-            e.system->Render();  
+            e.system->Extract(state); 
         }
     }
 }
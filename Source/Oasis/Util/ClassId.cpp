@@ -0,0 +1,74 @@
+#include "Oasis/Util/ClassId.h" 
+
+#include <mutex> 
+
+#ifdef __GNUC__ 
+#include <cxxabi.h> 
+#endif 
+
+namespace Oasis 
+{
+
+namespace 
+{
+    struct ClassRegistry 
+    {
+        std::mutex mutex; 
+        std::unordered_map<std::string, ClassId> ids[(int) ClassFamily::count]; 
+    };
+
+    // constructed on first use, ids can be requested during static initialization
+    ClassRegistry& GetRegistry() 
+    {
+        static ClassRegistry registry; 
+        return registry; 
+    }
+}
+
+ClassId RegisterClassId(ClassFamily family, const std::type_info& type) 
+{
+    ClassRegistry& registry = GetRegistry(); 
+    std::lock_guard<std::mutex> lock(registry.mutex); 
+
+    auto& ids = registry.ids[(int) family]; 
+    auto it = ids.find(type.name()); 
+
+    if (it != ids.end()) return it->second; 
+
+    ClassId id = ids.size(); 
+    ids[type.name()] = id; 
+
+    return id; 
+}
+
+uint32 GetClassIdCount(ClassFamily family) 
+{
+    ClassRegistry& registry = GetRegistry(); 
+    std::lock_guard<std::mutex> lock(registry.mutex); 
+
+    return registry.ids[(int) family].size(); 
+}
+
+std::string GetTypeName(const std::type_info& type) 
+{
+    std::string name = type.name(); 
+
+#ifdef __GNUC__ 
+    int status; 
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status); 
+
+    if (demangled) 
+    {
+        if (status == 0) name = demangled; 
+        std::free(demangled); 
+    }
+#else 
+    // MSVC prefixes the kind of type 
+    if (name.compare(0, 6, "class ") == 0) name.erase(0, 6); 
+    else if (name.compare(0, 7, "struct ") == 0) name.erase(0, 7); 
+#endif 
+
+    return name; 
+}
+
+}
@@ -39,8 +39,8 @@ void main()
 
 MeshRenderSystem::MeshRenderSystem() 
 {
-    Include<Transform>(); 
-    Include<MeshContainer>(); 
+    Read<WorldTransform>(); 
+    Read<MeshContainer>(); 
 
     CreateResources(); 
 }
@@ -67,6 +67,25 @@ void MeshRenderSystem::CreateResources()
 }
 
 void MeshRenderSystem::OnRender(Scene& scene, uint32 count, const EntityId* entities) 
+{
+    state_.Begin(&scene); 
+    OnExtract(scene, count, entities, state_); 
+    OnDraw(state_); 
+}
+
+void MeshRenderSystem::OnExtract(Scene& scene, uint32 count, const EntityId* entities, RenderState& state) 
+{
+    (void) scene; 
+    (void) count; 
+    (void) entities; 
+
+    ForEach<const WorldTransform, const MeshContainer>([&](const WorldTransform& transform, const MeshContainer& meshContainer) 
+    {
+        state.AddMesh(transform.matrix, meshContainer.mesh, meshContainer.material); 
+    }); 
+}
+
+void MeshRenderSystem::OnDraw(const RenderState& state) 
 {
     GraphicsDevice* gd = Engine::GetGraphicsDevice(); 
     Display* d = Engine::GetDisplay(); 
@@ -75,26 +94,22 @@ void MeshRenderSystem::OnRender(Scene& scene, uint32 count, const EntityId* enti
     gd->SetTextureUnit(0, texture_); 
 
     shader_->SetMatrix4("oa_View", Matrix4::IDENTITY); 
-    shader_->SetMatrix4("oa_Proj", Matrix4::Perspective(90 * OASIS_TO_RAD, d->GetAspectRatio(), 0.1, 100.0)); 
+    float aspect = d ? d->GetAspectRatio() : 1.0f; 
+    shader_->SetMatrix4("oa_Proj", Matrix4::Perspective(90 * OASIS_TO_RAD, aspect, 0.1, 100.0)); 
     shader_->SetTextureUnit("u_Texture", 0); 
 
-    for (uint32 i = 0; i < count; i++) 
+    for (auto& item : state.GetItems()) 
     {
-        Entity e = scene.GetEntity(entities[i]); 
-
-        Transform* transform = e.Get<Transform>(); 
-        MeshContainer* meshContainer = e.Get<MeshContainer>(); 
+        if (!item.mesh) continue; 
 
         shader_->SetVector3("u_Color", { 1, 1, 1 }); 
-        shader_->SetMatrix4("oa_Model", transform->CreateMatrix()); 
+        shader_->SetMatrix4("oa_Model", item.model); 
 
-        // Logger::Info(transform->CreateMatrix()); 
-
-        IndexBuffer* ib = meshContainer->mesh->GetIndexBuffer(0); 
-        VertexBuffer* vb = meshContainer->mesh->GetVertexBuffer(); 
+        IndexBuffer* ib = item.mesh->GetIndexBuffer(0); 
+        VertexBuffer* vb = item.mesh->GetVertexBuffer(); 
 
         gd->SetIndexBuffer(ib); 
         gd->SetVertexBuffer(vb); 
         gd->DrawIndexed(Primitive::TRIANGLE_LIST, 0, 6 * 6); 
     }
-}
\ No newline at end of file
+}
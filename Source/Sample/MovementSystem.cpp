@@ -2,22 +2,21 @@
 
 MovementSystem::MovementSystem() 
 {
-    Include<Transform>(); 
-    Include<Velocity>(); 
+    Write<LocalTransform>(); 
+    Read<Velocity>(); 
 }
 
 void MovementSystem::OnUpdate(Scene& scene, uint32 count, const EntityId* entities, float dt) 
 {
-    for (uint32 i = 0; i < count; i++) 
-    {
-        Entity e = scene.GetEntity(entities[i]); 
-
-        Transform& t = *e.Get<Transform>(); 
-        Velocity& v = *e.Get<Velocity>(); 
+    (void) scene; 
+    (void) count; 
+    (void) entities; 
 
+    ParallelForEach<LocalTransform, const Velocity>([=](LocalTransform& t, const Velocity& v) 
+    {
         t.position += v.positional * dt; 
         t.rotation = Quaternion::AxisAngle(Vector3::RIGHT, v.rotational.x * dt) * t.rotation; 
         t.rotation = Quaternion::AxisAngle(Vector3::UP, v.rotational.y * dt) * t.rotation; 
         t.rotation = Quaternion::AxisAngle(Vector3::FORWARD, v.rotational.z * dt) * t.rotation; 
-    }
+    }); 
 }
\ No newline at end of file
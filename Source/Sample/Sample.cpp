@@ -41,23 +41,27 @@ void SampleApp::Init()
 
     scene->AddSystem(new MovementSystem()); 
     scene->AddSystem(new MeshRenderSystem()); 
+    scene->AddSystem(new TransformHierarchySystem()); 
+
+    std::vector<Entity> entities = scene->CreateEntities<LocalTransform, WorldTransform, Velocity, MeshContainer>(13 * 5 * 7); 
+    unsigned index = 0; 
 
     for (int z = -10; z <= 2; z++) 
     for (int y = -2; y <= 2; y++) 
     for (int x = -3; x <= 3; x++) 
     {
-        Entity e = scene->CreateEntity(); 
+        Entity& e = entities[index++]; 
 
-        Transform* transform = e.Attach<Transform>(); 
+        LocalTransform* transform = e.Get<LocalTransform>(); 
         transform->position = Vector3(x, y, z - 3); 
         transform->rotation = Quaternion::AxisAngle(Vector3::UP, 15 * OASIS_TO_RAD);
         transform->scale = Vector3(0.25, 0.25, 0.25); 
         
-        Velocity* velocity = e.Attach<Velocity>(); 
+        Velocity* velocity = e.Get<Velocity>(); 
         velocity->positional = Vector3(rand() % 1000 * 0.0002 - 0.1, rand() % 1000 * 0.0002 - 0.1, rand() % 1000 * 0.0001 - 0.1); 
         velocity->rotational = Vector3(rand() % 40 * OASIS_TO_RAD, rand() % 40 * OASIS_TO_RAD, rand() % 40 * OASIS_TO_RAD); 
 
-        MeshContainer* meshContainer = e.Attach<MeshContainer>(); 
+        MeshContainer* meshContainer = e.Get<MeshContainer>(); 
         meshContainer->mesh = MeshUtil::CreateCube(); 
     }
 }